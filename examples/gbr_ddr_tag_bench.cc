@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Microbenchmark of the per-packet DDR state.
+ *
+ * A DDR packet used to carry a BudgetTag, a TimestampTag, a DistTag, a
+ * FlagTag and a PriorityTag, which every router peeked and partly replaced.
+ * This tags packets both ways, forwards them over a number of hops the way
+ * GBR::RouteInput does, checks that the state read back from the legacy tags
+ * matches the DdrTag, and prints the tag bytes per packet and the tagged
+ * hops per second of both.
+ */
+#include "ns3/core-module.h"
+#include "ns3/gbr-module.h"
+#include "ns3/network-module.h"
+#include "ns3/stats-module.h"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("GbrDdrTagBench");
+
+/**
+ * \brief Forward a packet tagged with the legacy tags over one hop.
+ * \param p the packet
+ * \param distance the distance of the route taken
+ * \return the remaining budget of the packet, in microsecond
+ */
+static int64_t
+LegacyHop(Ptr<Packet> p, uint32_t distance)
+{
+    BudgetTag budgetTag;
+    TimestampTag timestampTag;
+    DistTag distTag;
+    p->PeekPacketTag(budgetTag);
+    p->PeekPacketTag(timestampTag);
+    p->PeekPacketTag(distTag);
+    int64_t left = timestampTag.GetTimestamp().GetMicroSeconds() + budgetTag.GetBudget() -
+                   Simulator::Now().GetMicroSeconds();
+    if (distTag.GetDistance() != distance)
+    {
+        distTag.SetDistance(distance);
+        p->ReplacePacketTag(distTag);
+    }
+    return left;
+}
+
+/**
+ * \brief Forward a packet tagged with a DdrTag over one hop.
+ * \param p the packet
+ * \param distance the distance of the route taken
+ * \return the remaining budget of the packet, in microsecond
+ */
+static int64_t
+DdrHop(Ptr<Packet> p, uint32_t distance)
+{
+    DdrTag tag;
+    p->PeekPacketTag(tag);
+    int64_t left = tag.GetDeadline() - Simulator::Now().GetMicroSeconds();
+    if (tag.GetDistance() != distance)
+    {
+        tag.SetDistance(distance);
+        p->ReplacePacketTag(tag);
+    }
+    return left;
+}
+
+/**
+ * \brief Get the tag bytes a packet carries.
+ * \param p the packet
+ * \return the serialized size of its packet tags
+ */
+static uint32_t
+GetTagBytes(Ptr<const Packet> p)
+{
+    uint32_t bytes = 0;
+    PacketTagIterator i = p->GetPacketTagIterator();
+    while (i.HasNext())
+    {
+        PacketTagIterator::Item item = i.Next();
+        Callback<ObjectBase*> constructor = item.GetTypeId().GetConstructor();
+        Tag* tag = dynamic_cast<Tag*>(constructor());
+        item.GetTag(*tag);
+        bytes += tag->GetSerializedSize();
+        delete tag;
+    }
+    return bytes;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t nPackets = 100000;
+    uint32_t nHops = 8;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("packets", "Number of packets", nPackets);
+    cmd.AddValue("hops", "Hops per packet", nHops);
+    cmd.Parse(argc, argv);
+
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    std::vector<Ptr<Packet>> legacy;
+    std::vector<Ptr<Packet>> ddr;
+    for (uint32_t i = 0; i < nPackets; i++)
+    {
+        uint32_t budget = rng->GetInteger(1000, 200000);
+        bool measure = rng->GetInteger(0, 1) == 1;
+
+        Ptr<Packet> p = Create<Packet>(100);
+        BudgetTag budgetTag;
+        budgetTag.SetBudget(budget);
+        p->AddPacketTag(budgetTag);
+        TimestampTag timestampTag;
+        timestampTag.SetTimestamp(Simulator::Now());
+        p->AddPacketTag(timestampTag);
+        DistTag distTag;
+        distTag.SetDistance(UINT32_MAX - 1);
+        p->AddPacketTag(distTag);
+        FlagTag flagTag;
+        flagTag.SetFlag(measure);
+        p->AddPacketTag(flagTag);
+        PriorityTag priorityTag;
+        priorityTag.SetPriority(true);
+        p->AddPacketTag(priorityTag);
+        legacy.push_back(p);
+
+        p = Create<Packet>(100);
+        DdrTag tag;
+        tag.SetPriority(true);
+        tag.SetBudget(budget);
+        tag.SetMeasure(measure);
+        tag.SetTxTime(Simulator::Now());
+        p->AddPacketTag(tag);
+        ddr.push_back(p);
+    }
+
+    std::vector<uint32_t> distances(nHops);
+    for (uint32_t h = 0; h < nHops; h++)
+    {
+        distances[h] = rng->GetInteger(0, 3) == 0 ? 1000 : 1000 * (nHops - h);
+    }
+
+    int64_t sum = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < nPackets; i++)
+    {
+        for (uint32_t h = 0; h < nHops; h++)
+        {
+            sum += LegacyHop(legacy[i], distances[h]);
+        }
+    }
+    std::chrono::duration<double> before = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < nPackets; i++)
+    {
+        for (uint32_t h = 0; h < nHops; h++)
+        {
+            sum -= DdrHop(ddr[i], distances[h]);
+        }
+    }
+    std::chrono::duration<double> after = std::chrono::steady_clock::now() - start;
+    NS_ABORT_MSG_IF(sum != 0, "Remaining budgets differ");
+
+    for (uint32_t i = 0; i < nPackets; i++)
+    {
+        DdrTag fromLegacy;
+        DdrTag tag;
+        NS_ABORT_MSG_IF(!fromLegacy.PeekLegacyTags(legacy[i]), "No legacy tags");
+        ddr[i]->PeekPacketTag(tag);
+        NS_ABORT_MSG_IF(fromLegacy.GetBudget() != tag.GetBudget() ||
+                            fromLegacy.GetDeadline() != tag.GetDeadline() ||
+                            fromLegacy.GetTxTime() != tag.GetTxTime() ||
+                            fromLegacy.GetDistance() != tag.GetDistance() ||
+                            fromLegacy.GetMeasure() != tag.GetMeasure() ||
+                            fromLegacy.GetPriority() != tag.GetPriority(),
+                        "Tags of packet " << i << " differ");
+    }
+
+    uint64_t hops = static_cast<uint64_t>(nPackets) * nHops;
+    std::cout << "Legacy tags: " << GetTagBytes(legacy[0]) << " bytes/packet, "
+              << hops / before.count() << " hops/s" << std::endl;
+    std::cout << "DdrTag:      " << GetTagBytes(ddr[0]) << " bytes/packet, "
+              << hops / after.count() << " hops/s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Check of the DDR state forwarded by GBR::RouteInput.
+ *
+ * A line of three routers, n0 -- n1 -- n2.  n0 sends n2 a packet tagged with
+ * a DdrTag and a packet tagged with the legacy BudgetTag, TimestampTag,
+ * DistTag, FlagTag and PriorityTag.  Each router that changes the distance
+ * of a packet writes it on a single copy: the DdrTag of the new packets, the
+ * DistTag of the legacy ones.  The sink checks that both packets arrive with
+ * their budget and with the distance of the route n1 took, which is what
+ * the copies made before and after the lookup used to carry, and that no
+ * DdrTag was added to the legacy packet.
+ */
+#include "ns3/core-module.h"
+#include "ns3/gbr-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/stats-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("GbrDdrTagForwarding");
+
+/// payload size of the packet tagged with a DdrTag
+static const uint32_t DDR_PACKET_SIZE = 100;
+/// payload size of the packet tagged with the legacy tags
+static const uint32_t LEGACY_PACKET_SIZE = 200;
+/// port of the sink
+static const uint16_t SINK_PORT = 9;
+
+/**
+ * \brief The DDR state a packet arrived with.
+ */
+struct Arrival
+{
+    bool m_received;     //!< the packet arrived
+    bool m_hasDdrTag;    //!< it carries a DdrTag
+    uint32_t m_budget;   //!< its budget, in microsecond
+    uint32_t m_distance; //!< its distance
+};
+
+static Arrival g_ddrArrival = {false, false, 0, 0};    //!< the DdrTag packet
+static Arrival g_legacyArrival = {false, false, 0, 0}; //!< the legacy packet
+
+/**
+ * \brief Record the DDR state of the packets received by the sink.
+ * \param socket the sink socket
+ */
+static void
+ReceivePacket(Ptr<Socket> socket)
+{
+    Ptr<Packet> p;
+    while ((p = socket->Recv()))
+    {
+        Arrival& arrival = p->GetSize() == DDR_PACKET_SIZE ? g_ddrArrival : g_legacyArrival;
+        arrival.m_received = true;
+        DdrTag ddrTag;
+        arrival.m_hasDdrTag = p->PeekPacketTag(ddrTag);
+        if (arrival.m_hasDdrTag)
+        {
+            arrival.m_budget = ddrTag.GetBudget();
+            arrival.m_distance = ddrTag.GetDistance();
+        }
+        else
+        {
+            BudgetTag budgetTag;
+            DistTag distTag;
+            p->PeekPacketTag(budgetTag);
+            p->PeekPacketTag(distTag);
+            arrival.m_budget = budgetTag.GetBudget();
+            arrival.m_distance = distTag.GetDistance();
+        }
+    }
+}
+
+/**
+ * \brief Send a packet on a connected socket.
+ * \param socket the socket
+ * \param p the packet
+ */
+static void
+SendPacket(Ptr<Socket> socket, Ptr<Packet> p)
+{
+    socket->Send(p);
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string routeSelectMode("DGR");
+    uint32_t budget = 1000000;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("mode", "Route select mode [DGR|DDR|KSHORT].", routeSelectMode);
+    cmd.AddValue("budget", "Budget of the packets, in microsecond", budget);
+    cmd.Parse(argc, argv);
+    Config::SetDefault("ns3::GBR::RouteSelectMode", StringValue(routeSelectMode));
+
+    NodeContainer nodes;
+    nodes.Create(3);
+    GBRHelper gbr;
+    Ipv4ListRoutingHelper list;
+    list.Add(gbr, 10);
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(list);
+    internet.Install(nodes);
+
+    PointToPointHelper p2p;
+    p2p.SetChannelAttribute("Delay", StringValue("1ms"));
+    p2p.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
+    TrafficControlHelper tch;
+    tch.SetRootQueueDisc("ns3::ValueDenseQueueDisc");
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.252");
+    Ipv4InterfaceContainer sinkInterfaces;
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        NetDeviceContainer devices = p2p.Install(nodes.Get(i), nodes.Get(i + 1));
+        tch.Install(devices);
+        sinkInterfaces = address.Assign(devices);
+        address.NewNetwork();
+    }
+    GBRHelper::PopulateRoutingTables();
+    Ipv4Address sinkAddress = sinkInterfaces.GetAddress(1);
+
+    Ptr<Socket> sink = Socket::CreateSocket(nodes.Get(2), UdpSocketFactory::GetTypeId());
+    sink->Bind(InetSocketAddress(Ipv4Address::GetAny(), SINK_PORT));
+    sink->SetRecvCallback(MakeCallback(&ReceivePacket));
+    Ptr<Socket> source = Socket::CreateSocket(nodes.Get(0), UdpSocketFactory::GetTypeId());
+    source->Connect(InetSocketAddress(sinkAddress, SINK_PORT));
+
+    Ptr<Packet> ddrPacket = Create<Packet>(DDR_PACKET_SIZE);
+    DdrTag ddrTag;
+    ddrTag.SetPriority(true);
+    ddrTag.SetBudget(budget);
+    ddrTag.SetMeasure(true);
+    ddrTag.SetTxTime(Seconds(1));
+    ddrPacket->AddPacketTag(ddrTag);
+    Simulator::Schedule(Seconds(1), &SendPacket, source, ddrPacket);
+
+    Ptr<Packet> legacyPacket = Create<Packet>(LEGACY_PACKET_SIZE);
+    BudgetTag budgetTag;
+    budgetTag.SetBudget(budget);
+    legacyPacket->AddPacketTag(budgetTag);
+    TimestampTag timestampTag;
+    timestampTag.SetTimestamp(Seconds(1));
+    legacyPacket->AddPacketTag(timestampTag);
+    DistTag distTag;
+    distTag.SetDistance(UINT32_MAX - 1);
+    legacyPacket->AddPacketTag(distTag);
+    FlagTag flagTag;
+    flagTag.SetFlag(true);
+    legacyPacket->AddPacketTag(flagTag);
+    PriorityTag priorityTag;
+    priorityTag.SetPriority(true);
+    legacyPacket->AddPacketTag(priorityTag);
+    Simulator::Schedule(Seconds(1), &SendPacket, source, legacyPacket);
+
+    Simulator::Stop(Seconds(2));
+    Simulator::Run();
+
+    // the last route taken is the shortest route of n1 to the sink
+    Ptr<GBR> forwarder = nodes.Get(1)->GetObject<Router>()->GetRoutingProtocol();
+    uint32_t distance = UINT32_MAX;
+    for (uint32_t i = 0; i < forwarder->GetNRoutes(); i++)
+    {
+        RoutingTableEntry* route = forwarder->GetRoute(i);
+        if (route->IsHost() && route->GetDest() == sinkAddress)
+        {
+            distance = std::min(distance, route->GetDistance());
+        }
+    }
+    Simulator::Destroy();
+
+    NS_ABORT_MSG_IF(distance == UINT32_MAX, "No route of n1 to the sink");
+    NS_ABORT_MSG_IF(!g_ddrArrival.m_received, "The DdrTag packet was not received");
+    NS_ABORT_MSG_IF(!g_ddrArrival.m_hasDdrTag, "The DdrTag packet lost its tag");
+    NS_ABORT_MSG_IF(g_ddrArrival.m_budget != budget,
+                    "DdrTag budget " << g_ddrArrival.m_budget << ", expected " << budget);
+    NS_ABORT_MSG_IF(g_ddrArrival.m_distance != distance,
+                    "DdrTag distance " << g_ddrArrival.m_distance << ", expected " << distance);
+    NS_ABORT_MSG_IF(!g_legacyArrival.m_received, "The legacy packet was not received");
+    NS_ABORT_MSG_IF(g_legacyArrival.m_hasDdrTag, "A DdrTag was added to the legacy packet");
+    NS_ABORT_MSG_IF(g_legacyArrival.m_budget != budget,
+                    "BudgetTag budget " << g_legacyArrival.m_budget << ", expected " << budget);
+    NS_ABORT_MSG_IF(g_legacyArrival.m_distance != distance,
+                    "DistTag distance " << g_legacyArrival.m_distance << ", expected "
+                                        << distance);
+    std::cout << "Both packets arrived with budget " << budget << " and distance " << distance
+              << std::endl;
+    return 0;
+}
@@ -29,12 +29,15 @@ main(int argc, char* argv[])
     Packet::EnablePrinting();
     std::string topo("2_node");
     std::string format("Inet");
+    std::string delivery("Packet");
 
     // Set up command line parameters used to control the experiment.
     CommandLine cmd(__FILE__);
     cmd.AddValue("format", "Format to use for data input [Orbis|Inet|Rocketfuel].", format);
     cmd.AddValue("topo", "topology", topo);
+    cmd.AddValue("delivery", "Delivery of the neighbor states [Packet|Oracle].", delivery);
     cmd.Parse(argc, argv);
+    Config::SetDefault("ns3::GBR::StateDelivery", StringValue(delivery));
     std::string input("contrib/gbr/topo/Inet_" + topo + "_topo.txt");
     // ------------------------------------------------------------
     // -- Read topology data.
@@ -192,7 +195,11 @@ main(int argc, char* argv[])
     // -- Run the simulation
     // --------------------------------------------
     NS_LOG_INFO("Run Simulation.");
+    std::clock_t start = std::clock();
     Simulator::Run();
+    std::cout << "Simulation run time (" << delivery << " delivery): "
+              << double(std::clock() - start) / CLOCKS_PER_SEC << " s" << std::endl;
+    GBRHelper::PrintStatusUpdateStats(std::cout);
     Simulator::Destroy();
 
     delete[] ipic;
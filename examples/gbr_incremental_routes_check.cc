@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Check of the incremental route updates against a full recomputation.
+ *
+ * RouteManager::UpdateRoutes () reuses the SPF calculations a topology
+ * change cannot affect and reinstalls the tables of the routers it does
+ * affect.  This builds a random mesh, then flaps a link, and the address of
+ * a router by renumbering its primary address and back.  After each change
+ * it takes the tables installed by UpdateRoutes (), recomputes every route
+ * with DeleteRoutes (), BuildRoutingDatabase () and InitializeRoutes (), and
+ * aborts unless every router ends up with the same table, route for route.
+ * This runs with the "Spf" engine, with the tables keyed by address and with
+ * the compressed tables, on as many threads as --threads sets GBRSpfThreads
+ * to.
+ */
+#include "ns3/core-module.h"
+#include "ns3/gbr-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("GbrIncrementalRoutesCheck");
+
+/// routing tables of every router, one line per route, by node
+typedef std::vector<std::vector<std::string>> Tables_t;
+
+/**
+ * \brief Get the routing tables of every router.
+ * \param nodes the routers
+ * \return the tables
+ */
+static Tables_t
+GetTables(const NodeContainer& nodes)
+{
+    Tables_t tables(nodes.GetN());
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        Ptr<GBR> gbr = nodes.Get(n)->GetObject<Router>()->GetRoutingProtocol();
+        for (uint32_t i = 0; i < gbr->GetNRoutes(); i++)
+        {
+            std::ostringstream route;
+            route << *gbr->GetRoute(i) << " distance " << gbr->GetRoute(i)->GetDistance();
+            tables[n].push_back(route.str());
+        }
+    }
+    return tables;
+}
+
+/**
+ * \brief Update the routes incrementally and check them against a full
+ * recomputation.
+ * \param nodes the routers
+ * \param change the topology change the update follows
+ */
+static void
+CheckUpdate(const NodeContainer& nodes, const std::string& change)
+{
+    RouteManager::UpdateRoutes();
+    Tables_t incremental = GetTables(nodes);
+    RouteManager::DeleteRoutes();
+    RouteManager::BuildRoutingDatabase();
+    RouteManager::InitializeRoutes();
+    Tables_t full = GetTables(nodes);
+
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        NS_ABORT_MSG_IF(incremental[n].size() != full[n].size(),
+                        change << ": node " << n << " has " << incremental[n].size()
+                               << " routes, " << full[n].size() << " after a full update");
+        for (uint32_t i = 0; i < full[n].size(); i++)
+        {
+            NS_ABORT_MSG_IF(incremental[n][i] != full[n][i],
+                            change << ": route " << i << " of node " << n << " is "
+                                   << incremental[n][i] << ", " << full[n][i]
+                                   << " after a full update");
+        }
+    }
+    std::cout << "  " << change << ": tables identical" << std::endl;
+}
+
+/**
+ * \brief Build a random mesh, flap a link and an address, and check the
+ * incremental updates after each change.
+ * \param nNodes the number of routers
+ * \param nChords the number of links added to the ring of routers
+ * \param compressed true for compressed routing tables
+ */
+static void
+RunCheck(uint32_t nNodes, uint32_t nChords, bool compressed)
+{
+    std::cout << (compressed ? "Compressed" : "Uncompressed") << " tables" << std::endl;
+    GBRHelper::SetRouteEngine("Spf");
+    GBRHelper::SetCompressedTables(compressed);
+
+    NodeContainer nodes;
+    nodes.Create(nNodes);
+    GBRHelper gbr;
+    Ipv4ListRoutingHelper list;
+    list.Add(gbr, 10);
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(list);
+    internet.Install(nodes);
+
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    PointToPointHelper p2p;
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.252");
+    std::vector<NetDeviceContainer> links;
+    for (uint32_t i = 0; i < nNodes + nChords; i++)
+    {
+        uint32_t from = i < nNodes ? i : rng->GetInteger(0, nNodes - 1);
+        uint32_t to = i < nNodes ? (i + 1) % nNodes : rng->GetInteger(0, nNodes - 1);
+        if (from == to)
+        {
+            continue;
+        }
+        NetDeviceContainer devices = p2p.Install(nodes.Get(from), nodes.Get(to));
+        Ipv4InterfaceContainer interfaces = address.Assign(devices);
+        uint16_t metric = rng->GetInteger(1, 10);
+        interfaces.SetMetric(0, metric);
+        interfaces.SetMetric(1, metric);
+        address.NewNetwork();
+        links.push_back(devices);
+    }
+    GBRHelper::PopulateRoutingTables();
+
+    // the link flapped is a ring link, the address flapped the primary
+    // address of the last link, which is a chord if any
+    Ptr<NetDevice> device = links[0].Get(0);
+    Ptr<NetDevice> peer = links[0].Get(1);
+    Ptr<Ipv4> ipv4 = device->GetNode()->GetObject<Ipv4>();
+    Ptr<Ipv4> peerIpv4 = peer->GetNode()->GetObject<Ipv4>();
+    uint32_t interface = ipv4->GetInterfaceForDevice(device);
+    uint32_t peerInterface = peerIpv4->GetInterfaceForDevice(peer);
+
+    ipv4->SetDown(interface);
+    peerIpv4->SetDown(peerInterface);
+    CheckUpdate(nodes, "link down");
+    ipv4->SetUp(interface);
+    peerIpv4->SetUp(peerInterface);
+    CheckUpdate(nodes, "link up");
+
+    Ptr<NetDevice> addressed = links.back().Get(1);
+    Ptr<Ipv4> addressedIpv4 = addressed->GetNode()->GetObject<Ipv4>();
+    uint32_t addressedInterface = addressedIpv4->GetInterfaceForDevice(addressed);
+    Ipv4InterfaceAddress original = addressedIpv4->GetAddress(addressedInterface, 0);
+    Ipv4InterfaceAddress renumbered(Ipv4Address("10.254.0.1"), Ipv4Mask("255.255.255.252"));
+    // an interface never goes without an address, the LSAs need one
+    addressedIpv4->AddAddress(addressedInterface, renumbered);
+    addressedIpv4->RemoveAddress(addressedInterface, 0);
+    CheckUpdate(nodes, "address renumbered");
+    addressedIpv4->AddAddress(addressedInterface, original);
+    addressedIpv4->RemoveAddress(addressedInterface, 0);
+    CheckUpdate(nodes, "address restored");
+
+    Simulator::Destroy();
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t nNodes = 16;
+    uint32_t nChords = 16;
+    uint32_t threads = 1;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("nodes", "Number of routers", nNodes);
+    cmd.AddValue("chords", "Number of links added to the ring of routers", nChords);
+    cmd.AddValue("threads", "GBRSpfThreads (0 = one per hardware thread)", threads);
+    cmd.Parse(argc, argv);
+    NS_ABORT_MSG_IF(nNodes < 3, "At least 3 routers are needed");
+    Config::SetGlobal("GBRSpfThreads", UintegerValue(threads));
+
+    RunCheck(nNodes, nChords, false);
+    RunCheck(nNodes, nChords, true);
+    return 0;
+}
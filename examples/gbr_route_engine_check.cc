@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Check of the "ReverseSpf" route engine against the "Spf" one.
+ *
+ * RunReverseSPF () computes the routes of every job from one reverse
+ * shortest path tree per destination router instead of one SPF calculation
+ * per job.  This builds the abilene, att, geant and cernet topologies of
+ * topo/ with each engine, and aborts unless every router ends up with the
+ * same host routes under both: same destination, interface, next hop,
+ * distance and next interface, in the same order, which is the order the
+ * candidate routes of a destination are tried in.  It prints the wall-clock
+ * time of GBRHelper::PopulateRoutingTables () under each engine.
+ */
+#include "ns3/core-module.h"
+#include "ns3/gbr-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/topology-read-module.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("GbrRouteEngineCheck");
+
+/// host routes of every router, one line per route, by node
+typedef std::vector<std::vector<std::string>> Tables_t;
+
+/**
+ * \brief Get the host routes of every router.
+ * \param nodes the routers
+ * \return the host routes, in table order
+ */
+static Tables_t
+GetHostRoutes(const NodeContainer& nodes)
+{
+    Tables_t tables(nodes.GetN());
+    for (uint32_t n = 0; n < nodes.GetN(); n++)
+    {
+        Ptr<GBR> gbr = nodes.Get(n)->GetObject<Router>()->GetRoutingProtocol();
+        for (uint32_t i = 0; i < gbr->GetNRoutes(); i++)
+        {
+            RoutingTableEntry* route = gbr->GetRoute(i);
+            if (!route->IsHost())
+            {
+                continue;
+            }
+            std::ostringstream line;
+            line << *route << " distance " << route->GetDistance() << " next out "
+                 << route->GetNextInterface();
+            tables[n].push_back(line.str());
+        }
+    }
+    return tables;
+}
+
+/**
+ * \brief Build a topology of topo/ and compute its routing tables.
+ * \param topo the name of the topology
+ * \param engine the route engine, "Spf" or "ReverseSpf"
+ * \param tables the host routes computed
+ * \return the wall-clock time of the computation, in seconds
+ */
+static double
+BuildTables(const std::string& topo, const std::string& engine, Tables_t& tables)
+{
+    GBRHelper::SetRouteEngine(engine);
+    TopologyReaderHelper topoHelp;
+    topoHelp.SetFileName("contrib/gbr/topo/Inet_" + topo + "_topo.txt");
+    topoHelp.SetFileType("Inet");
+    Ptr<TopologyReader> inFile = topoHelp.GetTopologyReader();
+    NodeContainer nodes = inFile->Read();
+    NS_ABORT_MSG_IF(inFile->LinksSize() == 0, "Problems reading topology " << topo);
+
+    GBRHelper gbr;
+    Ipv4ListRoutingHelper list;
+    list.Add(gbr, 10);
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(list);
+    internet.Install(nodes);
+
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.252");
+    for (TopologyReader::ConstLinksIterator iter = inFile->LinksBegin();
+         iter != inFile->LinksEnd();
+         iter++)
+    {
+        // the weight of a link is its delay, in milliseconds, and its metric
+        std::string delay = iter->GetAttribute("Weight");
+        std::stringstream ss;
+        ss << delay;
+        uint16_t metric;
+        ss >> metric;
+        p2p.SetChannelAttribute("Delay", StringValue(delay + "ms"));
+        NetDeviceContainer devices = p2p.Install(iter->GetFromNode(), iter->GetToNode());
+        Ipv4InterfaceContainer interfaces = address.Assign(devices);
+        interfaces.SetMetric(0, metric);
+        interfaces.SetMetric(1, metric);
+        address.NewNetwork();
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    GBRHelper::PopulateRoutingTables();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    tables = GetHostRoutes(nodes);
+    Simulator::Destroy();
+    return elapsed.count();
+}
+
+/**
+ * \brief Check that both engines compute the same host routes on a topology.
+ * \param topo the name of the topology
+ */
+static void
+CheckTopology(const std::string& topo)
+{
+    Tables_t spf;
+    Tables_t reverse;
+    double spfTime = BuildTables(topo, "Spf", spf);
+    double reverseTime = BuildTables(topo, "ReverseSpf", reverse);
+
+    NS_ABORT_MSG_IF(spf.size() != reverse.size(), topo << ": the node counts differ");
+    uint64_t nRoutes = 0;
+    for (uint32_t n = 0; n < spf.size(); n++)
+    {
+        NS_ABORT_MSG_IF(spf[n].size() != reverse[n].size(),
+                        topo << ": node " << n << " has " << reverse[n].size()
+                             << " host routes, " << spf[n].size() << " with Spf");
+        for (uint32_t i = 0; i < spf[n].size(); i++)
+        {
+            NS_ABORT_MSG_IF(spf[n][i] != reverse[n][i],
+                            topo << ": host route " << i << " of node " << n << " is "
+                                 << reverse[n][i] << ", " << spf[n][i] << " with Spf");
+        }
+        nRoutes += spf[n].size();
+    }
+    std::cout << topo << ": " << spf.size() << " nodes, " << nRoutes
+              << " host routes identical; PopulateRoutingTables " << spfTime * 1000
+              << " ms with Spf, " << reverseTime * 1000 << " ms with ReverseSpf" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t threads = 1;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("threads", "GBRSpfThreads (0 = one per hardware thread)", threads);
+    cmd.Parse(argc, argv);
+    Config::SetGlobal("GBRSpfThreads", UintegerValue(threads));
+
+    const char* topos[] = {"abilene", "att", "geant", "cernet"};
+    for (uint32_t i = 0; i < sizeof(topos) / sizeof(topos[0]); i++)
+    {
+        CheckTopology(topos[i]);
+    }
+    return 0;
+}
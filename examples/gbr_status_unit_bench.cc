@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Microbenchmark of the DDR delay estimate of the neighbor status units.
+ *
+ * GBR reads StatusUnit::GetEstimateDelayDDR () for every candidate route of
+ * every forwarded packet.  This feeds a set of status units with random
+ * state transitions, then times the lookups against a reference that
+ * recomputes the weighted sum over the transition row on every lookup, as
+ * the estimate used to be computed, and checks that both agree.
+ */
+#include "ns3/core-module.h"
+#include "ns3/gbr-module.h"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("GbrStatusUnitBench");
+
+/**
+ * \brief A status unit estimating the DDR delay from its transition matrix
+ * on every lookup.
+ */
+class ReferenceStatusUnit
+{
+  public:
+    ReferenceStatusUnit()
+        : m_matrix{{0}},
+          m_state(0)
+    {
+    }
+
+    /**
+     * \brief Record a transition to a state.
+     * \param state the new state
+     */
+    void Update(int state)
+    {
+        m_matrix[m_state][state]++;
+        m_state = state;
+    }
+
+    /**
+     * \returns the expected delay of the next state, in microseconds
+     */
+    uint32_t GetEstimateDelayDDR() const
+    {
+        uint32_t ret = 0;
+        uint32_t counter = 0;
+        for (int i = 0; i < STATESIZE; i++)
+        {
+            ret += m_matrix[m_state][i] * i;
+            counter += m_matrix[m_state][i];
+        }
+        return counter == 0 ? m_state * 2000 : ret * 2000 / counter;
+    }
+
+  private:
+    int m_matrix[STATESIZE][STATESIZE]; //!< transition counts
+    int m_state;                        //!< last state
+};
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t nUnits = 64;
+    uint32_t nUpdates = 1000;
+    uint32_t nLookups = 10000000;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("units", "Number of status units", nUnits);
+    cmd.AddValue("updates", "State updates per status unit", nUpdates);
+    cmd.AddValue("lookups", "Number of timed lookups", nLookups);
+    cmd.Parse(argc, argv);
+
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    std::vector<StatusUnit> units(nUnits);
+    std::vector<ReferenceStatusUnit> references(nUnits);
+    for (uint32_t u = 0; u < nUnits; u++)
+    {
+        for (uint32_t i = 0; i < nUpdates; i++)
+        {
+            int state = rng->GetInteger(0, STATESIZE - 1);
+            units[u].Update(state);
+            references[u].Update(state);
+        }
+        if (units[u].GetEstimateDelayDDR() != references[u].GetEstimateDelayDDR())
+        {
+            NS_FATAL_ERROR("Estimates of unit " << u << " differ");
+        }
+    }
+
+    uint64_t sum = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < nLookups; i++)
+    {
+        sum += references[i % nUnits].GetEstimateDelayDDR();
+    }
+    std::chrono::duration<double> before = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < nLookups; i++)
+    {
+        sum -= units[i % nUnits].GetEstimateDelayDDR();
+    }
+    std::chrono::duration<double> after = std::chrono::steady_clock::now() - start;
+
+    NS_ABORT_MSG_IF(sum != 0, "Estimates differ");
+    std::cout << "Recomputed estimate: " << nLookups / before.count() << " lookups/s"
+              << std::endl;
+    std::cout << "Cached estimate:     " << nLookups / after.count() << " lookups/s"
+              << std::endl;
+    return 0;
+}
@@ -19,11 +19,16 @@
  */
 #include "gbr-routing-helper.h"
 
+#include "ns3/boolean.h"
+#include "ns3/config.h"
 #include "ns3/ipv4-gbr-routing.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/log.h"
+#include "ns3/node-list.h"
 #include "ns3/router-interface.h"
+#include "ns3/string.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/uinteger.h"
 
 namespace ns3
 {
@@ -82,6 +87,84 @@ GBRHelper::RecomputeRoutingTables(void)
     RouteManager::InitializeRoutes();
 }
 
+bool
+GBRHelper::LoadRoutingTables(std::string path)
+{
+    RouteManager::BuildRoutingDatabase();
+    if (RouteManager::LoadRoutingTables(path))
+    {
+        return true;
+    }
+    RouteManager::InitializeRoutes();
+    return false;
+}
+
+bool
+GBRHelper::SaveRoutingTables(std::string path)
+{
+    return RouteManager::SaveRoutingTables(path);
+}
+
+void
+GBRHelper::PrintStatusUpdateStats(std::ostream& os)
+{
+    uint64_t nPackets = 0;
+    uint64_t nBytes = 0;
+    uint64_t nPeriodicPackets = 0;
+    uint64_t nPeriodicBytes = 0;
+    for (NodeList::Iterator i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<Router> rtr = (*i)->GetObject<Router>();
+        if (!rtr || !rtr->GetRoutingProtocol())
+        {
+            continue;
+        }
+        Ptr<GBR> gbr = rtr->GetRoutingProtocol();
+        nPackets += gbr->GetNStatusUpdatePackets();
+        nBytes += gbr->GetNStatusUpdateBytes();
+        nPeriodicPackets += gbr->GetNPeriodicStatusUpdatePackets();
+        nPeriodicBytes += gbr->GetNPeriodicStatusUpdateBytes();
+    }
+    os << "Neighbor status updates: " << nPackets << " packets, " << nBytes << " bytes\n";
+    os << "Periodic updates would send: " << nPeriodicPackets << " packets, " << nPeriodicBytes
+       << " bytes\n";
+    if (nPeriodicPackets >= nPackets && nPeriodicBytes > nBytes)
+    {
+        os << "Saved: " << nPeriodicPackets - nPackets << " packets, "
+           << nPeriodicBytes - nBytes << " bytes\n";
+    }
+}
+
+void
+GBRHelper::SetRouteEngine(std::string engine)
+{
+    Config::SetGlobal("GBRRouteEngine", StringValue(engine));
+}
+
+void
+GBRHelper::SetCompressedTables(bool compressed)
+{
+    Config::SetGlobal("GBRCompressedTables", BooleanValue(compressed));
+}
+
+void
+GBRHelper::SetLazyRoutes(bool lazy)
+{
+    Config::SetGlobal("GBRLazyRoutes", BooleanValue(lazy));
+}
+
+void
+GBRHelper::SetCentralSampler(bool central)
+{
+    Config::SetGlobal("GBRCentralSampler", BooleanValue(central));
+}
+
+void
+GBRHelper::SetSamplerPhaseSlots(uint32_t slots)
+{
+    Config::SetGlobal("GBRSamplerPhaseSlots", UintegerValue(slots));
+}
+
 QueueDiscContainer
 GBRHelper::Install(Ptr<Node> node)
 {
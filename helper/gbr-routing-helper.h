@@ -90,6 +90,117 @@ class GBRHelper : public Ipv4RoutingHelper
      *
      */
     static void RecomputeRoutingTables(void);
+    /**
+     * \brief Populate the routing tables from a snapshot saved by
+     * SaveRoutingTables(), skipping the SPF calculations.
+     *
+     * Builds the routing database as PopulateRoutingTables() does, then
+     * installs the routes of the snapshot if it was saved for the same
+     * topology (same LSAs and router addresses).  Otherwise the routes are
+     * computed as PopulateRoutingTables() does, so a simulation can run
+     *
+     *   if (!GBRHelper::LoadRoutingTables (path))
+     *     {
+     *       GBRHelper::SaveRoutingTables (path);
+     *     }
+     *
+     * and only compute its routes on the first run.
+     *
+     * \param path the snapshot file
+     * \returns true if the routes were loaded, false if they were computed
+     */
+    static bool LoadRoutingTables(std::string path);
+    /**
+     * \brief Save the routes computed by PopulateRoutingTables() or
+     * RecomputeRoutingTables() to a snapshot file.
+     *
+     * The snapshot is a compact, versioned binary file keyed by a hash of
+     * the topology.  Lazy routes (SetLazyRoutes()) and loaded routes cannot
+     * be saved.
+     *
+     * \param path the snapshot file
+     * \returns true if the routes were saved
+     */
+    static bool SaveRoutingTables(std::string path);
+    /**
+     * \brief Print the neighbor status update traffic of all the routers,
+     * and what the periodic updates would have sent instead.
+     *
+     * Compares the triggered updates (the ns3::GBR::UpdateMode attribute)
+     * with the periodic ones; in periodic mode both counts are the same.
+     *
+     * \param os the output stream
+     */
+    static void PrintStatusUpdateStats(std::ostream& os);
+    /**
+     * \brief Select the algorithm PopulateRoutingTables() and
+     * RecomputeRoutingTables() use to compute the routing tables.
+     *
+     * This sets the GBRRouteEngine global value.  Both engines install the
+     * same host routes; "ReverseSpf" runs one calculation per destination
+     * instead of one per router and neighbor, and falls back to "Spf" on
+     * topologies it does not support.
+     *
+     * \param engine "Spf" (the default) or "ReverseSpf"
+     */
+    static void SetRouteEngine(std::string engine);
+
+    /**
+     * \brief Select whether PopulateRoutingTables() and
+     * RecomputeRoutingTables() install compressed routing tables.
+     *
+     * This sets the GBRCompressedTables global value.  A compressed table
+     * holds one host route per destination router and output interface,
+     * keyed by the router ID, instead of one per address of the router; the
+     * lookups map a destination address to its router through an index shared
+     * by all the routers.
+     *
+     * \param compressed true for compressed tables, false (the default) for
+     * one host route per destination address
+     */
+    static void SetCompressedTables(bool compressed);
+
+    /**
+     * \brief Select whether PopulateRoutingTables() and
+     * RecomputeRoutingTables() compute the routes to a destination only
+     * when a router first looks one up.
+     *
+     * This sets the GBRLazyRoutes global value.  The routes to the
+     * neighbors are installed up front; the routes to any other destination
+     * router are computed by a single reverse SPF calculation the first time
+     * a packet is routed to it, and are the same as computed up front.
+     *
+     * \param lazy true for lazy routes, false (the default) to compute every
+     * route up front
+     */
+    static void SetLazyRoutes(bool lazy);
+
+    /**
+     * \brief Select whether the neighbor status of the routers is sampled
+     * by the central sampler.
+     *
+     * This sets the GBRCentralSampler global value, and applies to the
+     * routers initialized afterwards.  The central sampler samples all the
+     * routers sharing a sample period from one event per period and phase
+     * instead of one per router; each router still samples and sends its
+     * updates once per period.
+     *
+     * \param central true for the central sampler, false (the default) for
+     * one sampling event per router
+     */
+    static void SetCentralSampler(bool central);
+
+    /**
+     * \brief Set the number of phases of the central sampler.
+     *
+     * This sets the GBRSamplerPhaseSlots global value.  The sample period is
+     * divided into that many equally spaced phases, and each router is
+     * sampled at one of them, drawn at random.
+     *
+     * \param slots the number of phases, 1 (the default) to sample every
+     * router at the same time
+     */
+    static void SetSamplerPhaseSlots(uint32_t slots);
 
     /**
      * \param node Node
@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "host-route-index.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("HostRouteIndex");
+
+/// initial number of slots, must be a power of two
+static const uint32_t HOST_ROUTE_INDEX_INITIAL_SLOTS = 16;
+
+HostRouteIndex::Slot::Slot()
+    : m_used(false),
+      m_dest(0)
+{
+}
+
+HostRouteIndex::HostRouteIndex()
+    : m_slots(HOST_ROUTE_INDEX_INITIAL_SLOTS),
+      m_mask(HOST_ROUTE_INDEX_INITIAL_SLOTS - 1),
+      m_nDest(0),
+      m_aliases(nullptr)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+HostRouteIndex::~HostRouteIndex()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint32_t
+HostRouteIndex::Hash(uint32_t dest) const
+{
+    // Fibonacci hashing: addresses are usually allocated sequentially, so
+    // spread the low bits before masking.
+    uint32_t h = dest * 2654435769U;
+    return (h ^ (h >> 16)) & m_mask;
+}
+
+uint32_t
+HostRouteIndex::FindSlot(uint32_t dest) const
+{
+    uint32_t i = Hash(dest);
+    while (m_slots[i].m_used && m_slots[i].m_dest != dest)
+    {
+        i = (i + 1) & m_mask;
+    }
+    return i;
+}
+
+void
+HostRouteIndex::Grow(void)
+{
+    NS_LOG_FUNCTION(this << m_slots.size());
+    std::vector<Slot> old;
+    old.swap(m_slots);
+    m_slots.resize(old.size() * 2);
+    m_mask = m_slots.size() - 1;
+    for (std::vector<Slot>::iterator i = old.begin(); i != old.end(); i++)
+    {
+        if (i->m_used)
+        {
+            Slot& slot = m_slots[FindSlot(i->m_dest)];
+            slot.m_used = true;
+            slot.m_dest = i->m_dest;
+            slot.m_routes.swap(i->m_routes);
+        }
+    }
+}
+
+void
+HostRouteIndex::Erase(uint32_t i)
+{
+    // Backward shift deletion: move up the entries whose probe chain passes
+    // through the freed slot so that no tombstones are needed.
+    uint32_t j = i;
+    while (true)
+    {
+        j = (j + 1) & m_mask;
+        if (!m_slots[j].m_used)
+        {
+            break;
+        }
+        uint32_t k = Hash(m_slots[j].m_dest);
+        bool stay = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (stay)
+        {
+            continue;
+        }
+        m_slots[i].m_dest = m_slots[j].m_dest;
+        m_slots[i].m_routes.swap(m_slots[j].m_routes);
+        i = j;
+    }
+    m_slots[i].m_used = false;
+    m_slots[i].m_dest = 0;
+    m_slots[i].m_routes.clear();
+    m_nDest--;
+}
+
+void
+HostRouteIndex::Insert(RoutingTableEntry* route)
+{
+    NS_LOG_FUNCTION(this << route);
+    NS_ASSERT(route->IsHost());
+    if ((m_nDest + 1) * 2 > m_slots.size())
+    {
+        Grow();
+    }
+    uint32_t dest = route->GetDest().Get();
+    Slot& slot = m_slots[FindSlot(dest)];
+    if (!slot.m_used)
+    {
+        slot.m_used = true;
+        slot.m_dest = dest;
+        m_nDest++;
+    }
+    slot.m_routes.push_back(route);
+}
+
+void
+HostRouteIndex::Remove(RoutingTableEntry* route)
+{
+    NS_LOG_FUNCTION(this << route);
+    uint32_t i = FindSlot(route->GetDest().Get());
+    if (!m_slots[i].m_used)
+    {
+        return;
+    }
+    Candidates& routes = m_slots[i].m_routes;
+    Candidates::iterator it = std::find(routes.begin(), routes.end(), route);
+    if (it != routes.end())
+    {
+        routes.erase(it);
+    }
+    if (routes.empty())
+    {
+        Erase(i);
+    }
+}
+
+const HostRouteIndex::Candidates*
+HostRouteIndex::Lookup(Ipv4Address dest) const
+{
+    if (m_aliases)
+    {
+        Aliases::const_iterator alias = m_aliases->find(dest);
+        if (alias != m_aliases->end())
+        {
+            dest = alias->second;
+        }
+    }
+    return Find(dest);
+}
+
+const HostRouteIndex::Candidates*
+HostRouteIndex::Find(Ipv4Address dest) const
+{
+    const Slot& slot = m_slots[FindSlot(dest.Get())];
+    if (!slot.m_used)
+    {
+        return nullptr;
+    }
+    return &slot.m_routes;
+}
+
+void
+HostRouteIndex::SetAliases(const Aliases* aliases)
+{
+    NS_LOG_FUNCTION(this << aliases);
+    m_aliases = aliases;
+}
+
+void
+HostRouteIndex::Clear(void)
+{
+    NS_LOG_FUNCTION(this);
+    m_slots.clear();
+    m_slots.resize(HOST_ROUTE_INDEX_INITIAL_SLOTS);
+    m_mask = HOST_ROUTE_INDEX_INITIAL_SLOTS - 1;
+    m_nDest = 0;
+}
+
+uint32_t
+HostRouteIndex::GetNDestinations(void) const
+{
+    return m_nDest;
+}
+
+} // namespace ns3
@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef HOST_ROUTE_INDEX_H
+#define HOST_ROUTE_INDEX_H
+
+#include "routing-table-entry.h"
+
+#include "ns3/ipv4-address.h"
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Destination-keyed index over the host routes of a GBR table.
+ *
+ * The index is an open-addressing hash table (linear probing) from a
+ * destination address to the contiguous list of routing table entries that
+ * reach it, i.e., the candidate next hops of that destination.  Candidates
+ * keep the order in which the routes were installed, so a lookup sees them in
+ * the same order as a walk of the host route list would.
+ *
+ * In a compressed table the routes are keyed by router ID, one per router
+ * and output interface instead of one per address of the router; the
+ * aliases given to the index then map each address of a router to its ID
+ * before a lookup.
+ *
+ * The index does not own the entries; the routing table does.
+ */
+class HostRouteIndex
+{
+  public:
+    /// contiguous span of candidate entries for one destination
+    typedef std::vector<RoutingTableEntry*> Candidates;
+    /// address to the key of the routes reaching it, shared between tables
+    typedef std::unordered_map<Ipv4Address, Ipv4Address, Ipv4AddressHash> Aliases;
+
+    HostRouteIndex();
+    ~HostRouteIndex();
+
+    /**
+     * \brief Add a host route to the index.
+     * \param route the routing table entry to add
+     */
+    void Insert(RoutingTableEntry* route);
+
+    /**
+     * \brief Remove a host route from the index.
+     * \param route the routing table entry to remove
+     */
+    void Remove(RoutingTableEntry* route);
+
+    /**
+     * \brief Get the candidate entries of a destination.
+     *
+     * The destination is first replaced by its alias, if it has one.
+     *
+     * \param dest the destination address
+     * \return the candidates, or a null pointer if no route reaches dest
+     */
+    const Candidates* Lookup(Ipv4Address dest) const;
+
+    /**
+     * \brief Get the entries inserted with a destination, ignoring the aliases.
+     * \param dest the destination of the entries
+     * \return the entries, or a null pointer if there are none
+     */
+    const Candidates* Find(Ipv4Address dest) const;
+
+    /**
+     * \brief Set the aliases applied by Lookup ().
+     *
+     * The aliases are not owned by the index and must outlive it, or be
+     * unset first.
+     *
+     * \param aliases the aliases, or a null pointer for none
+     */
+    void SetAliases(const Aliases* aliases);
+
+    /**
+     * \brief Remove every route from the index.
+     */
+    void Clear(void);
+
+    /**
+     * \return the number of destinations in the index
+     */
+    uint32_t GetNDestinations(void) const;
+
+  private:
+    /**
+     * \brief A slot of the hash table.
+     */
+    struct Slot
+    {
+        Slot();
+        bool m_used;         //!< true if the slot holds a destination
+        uint32_t m_dest;     //!< destination address (host order)
+        Candidates m_routes; //!< routes to the destination
+    };
+
+    /**
+     * \brief Home slot of a destination.
+     * \param dest destination address (host order)
+     * \return the slot where the probe sequence of dest starts
+     */
+    uint32_t Hash(uint32_t dest) const;
+
+    /**
+     * \brief Find the slot of a destination.
+     * \param dest destination address (host order)
+     * \return the slot holding dest, or the empty slot where it would go
+     */
+    uint32_t FindSlot(uint32_t dest) const;
+
+    /**
+     * \brief Double the number of slots and re-insert every destination.
+     */
+    void Grow(void);
+
+    /**
+     * \brief Empty a slot, shifting back the entries of its probe chain.
+     * \param i the slot to empty
+     */
+    void Erase(uint32_t i);
+
+    std::vector<Slot> m_slots; //!< hash table, size is a power of two
+    uint32_t m_mask;           //!< number of slots minus one
+    uint32_t m_nDest;          //!< number of used slots
+    const Aliases* m_aliases;  //!< aliases of the destinations, if any
+};
+
+} // namespace ns3
+
+#endif /* HOST_ROUTE_INDEX_H */
@@ -21,6 +21,8 @@
 #include "packet-headers.h"
 #include "packet-tags.h"
 #include "route-manager.h"
+#include "router-interface.h"
+#include "status-sampler.h"
 #include "value-dense-queue-disc.h"
 
 #include "ns3/boolean.h"
@@ -36,11 +38,13 @@
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/point-to-point-module.h"
+#include "ns3/simulation-singleton.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
 #include "ns3/traffic-control-module.h"
 #include "ns3/udp-header.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
 
 #include <iomanip>
 #include <string>
@@ -81,6 +85,38 @@ GBR::GetTypeId(void)
                           TimeValue(MilliSeconds(10)),
                           MakeTimeAccessor(&GBR::m_unsolicitedUpdate),
                           MakeTimeChecker())
+            .AddAttribute("UpdateMode",
+                          "Send every neighbor state every sample period, or only the states "
+                          "that changed since they were last sent",
+                          EnumValue(PERIODIC_UPDATE),
+                          MakeEnumAccessor(&GBR::m_updateMode),
+                          MakeEnumChecker(PERIODIC_UPDATE,
+                                          "Periodic",
+                                          TRIGGERED_UPDATE,
+                                          "Triggered"))
+            .AddAttribute("StateDelivery",
+                          "Send the neighbor states in UDP packets, or hand them to the "
+                          "neighbors directly after the propagation delay of the link",
+                          EnumValue(PACKET_DELIVERY),
+                          MakeEnumAccessor(&GBR::m_stateDelivery),
+                          MakeEnumChecker(PACKET_DELIVERY, "Packet", ORACLE_DELIVERY, "Oracle"))
+            .AddAttribute("MinTriggeredUpdateInterval",
+                          "Min time between two Triggered Neighbor State Updates.",
+                          TimeValue(MilliSeconds(20)),
+                          MakeTimeAccessor(&GBR::m_minTriggeredUpdateInterval),
+                          MakeTimeChecker())
+            .AddAttribute("FullUpdatePeriod",
+                          "Time between two Neighbor State Updates carrying every state, "
+                          "with triggered updates.",
+                          TimeValue(MilliSeconds(100)),
+                          MakeTimeAccessor(&GBR::m_fullUpdatePeriod),
+                          MakeTimeChecker())
+            .AddAttribute("HeaderVersion",
+                          "Encoding of the neighbor state entries sent: 2 for 32-bit fields, "
+                          "3 for an 8-bit interface and state per entry",
+                          UintegerValue(3),
+                          MakeUintegerAccessor(&GBR::m_headerVersion),
+                          MakeUintegerChecker<uint8_t>(2, 3))
             .AddAttribute("RouteSelectMode",
                           "Routing Select Mode",
                           EnumValue(NONE),
@@ -92,7 +128,19 @@ GBR::GetTypeId(void)
 GBR::GBR()
     : m_randomEcmpRouting(false),
       m_respondToInterfaceEvents(false),
-      m_nsdb()
+      m_nsdb(),
+      m_centralSampling(false),
+      m_updateMode(PERIODIC_UPDATE),
+      m_stateDelivery(PACKET_DELIVERY),
+      m_headerVersion(3),
+      m_nUpdatePackets(0),
+      m_nUpdateBytes(0),
+      m_nPeriodicUpdatePackets(0),
+      m_nPeriodicUpdateBytes(0),
+      m_updateOverhead(0),
+      m_updateNseSize(0),
+      m_nUpdateNses(0),
+      m_interfaceCacheValid(false)
 {
     NS_LOG_FUNCTION(this);
     m_rand = CreateObject<UniformRandomVariable>();
@@ -109,7 +157,9 @@ GBR::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface)
     NS_LOG_FUNCTION(this << dest << nextHop << interface);
     RoutingTableEntry* route = new RoutingTableEntry();
     *route = RoutingTableEntry::CreateHostRouteTo(dest, nextHop, interface);
+    BuildIpv4Route(route);
     m_hostRoutes.push_back(route);
+    m_hostRouteIndex.Insert(route);
 }
 
 void
@@ -118,7 +168,9 @@ GBR::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
     NS_LOG_FUNCTION(this << dest << interface);
     RoutingTableEntry* route = new RoutingTableEntry();
     *route = RoutingTableEntry::CreateHostRouteTo(dest, interface);
+    BuildIpv4Route(route);
     m_hostRoutes.push_back(route);
+    m_hostRouteIndex.Insert(route);
 }
 
 /**
@@ -142,7 +194,9 @@ GBR::AddHostRouteTo(Ipv4Address dest,
     RoutingTableEntry* route = new RoutingTableEntry();
     *route =
         RoutingTableEntry::CreateHostRouteTo(dest, nextHop, interface, nextInterface, distance);
+    BuildIpv4Route(route);
     m_hostRoutes.push_back(route);
+    m_hostRouteIndex.Insert(route);
 }
 
 void
@@ -154,6 +208,7 @@ GBR::AddNetworkRouteTo(Ipv4Address network,
     NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
     RoutingTableEntry* route = new RoutingTableEntry();
     *route = RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
+    BuildIpv4Route(route);
     m_networkRoutes.push_back(route);
 }
 
@@ -163,6 +218,7 @@ GBR::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask, uint32_t inter
     NS_LOG_FUNCTION(this << network << networkMask << interface);
     RoutingTableEntry* route = new RoutingTableEntry();
     *route = RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, interface);
+    BuildIpv4Route(route);
     m_networkRoutes.push_back(route);
 }
 
@@ -175,9 +231,48 @@ GBR::AddASExternalRouteTo(Ipv4Address network,
     NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
     RoutingTableEntry* route = new RoutingTableEntry();
     *route = RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
+    BuildIpv4Route(route);
     m_ASexternalRoutes.push_back(route);
 }
 
+bool
+GBR::HasHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface) const
+{
+    NS_LOG_FUNCTION(this << dest << nextHop << interface);
+    const HostRouteIndex::Candidates* routes = m_hostRouteIndex.Find(dest);
+    if (routes == nullptr)
+    {
+        return false;
+    }
+    for (HostRouteIndex::Candidates::const_iterator i = routes->begin(); i != routes->end(); i++)
+    {
+        if ((*i)->GetInterface() == interface && (*i)->GetGateway() == nextHop)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+GBR::SetHostRouteAliases(const HostRouteIndex::Aliases* aliases)
+{
+    NS_LOG_FUNCTION(this << aliases);
+    m_hostRouteIndex.SetAliases(aliases);
+}
+
+const HostRouteIndex::Candidates*
+GBR::LookupCandidates(Ipv4Address dest)
+{
+    const HostRouteIndex::Candidates* candidates = m_hostRouteIndex.Lookup(dest);
+    if (candidates == nullptr && RouteManager::ResolveRoutesTo(dest))
+    {
+        // the routes to dest were not computed yet (GBRLazyRoutes)
+        candidates = m_hostRouteIndex.Lookup(dest);
+    }
+    return candidates;
+}
+
 Ptr<Ipv4Route>
 GBR::LookupECMPRoute(Ipv4Address dest, Ptr<NetDevice> oif)
 {
@@ -192,23 +287,31 @@ GBR::LookupECMPRoute(Ipv4Address dest, Ptr<NetDevice> oif)
     typedef std::vector<RoutingTableEntry*> RouteVec_t;
     RouteVec_t allRoutes;
 
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    const HostRouteIndex::Candidates* candidates = LookupCandidates(dest);
+    if (candidates == nullptr)
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
+        NS_LOG_LOGIC("No host route to " << dest);
+        return 0;
+    }
+    NS_LOG_LOGIC("Number of candidate routes = " << candidates->size());
+    if (!m_interfaceCacheValid)
+    {
+        UpdateInterfaceCache();
+    }
+    for (HostRouteIndex::Candidates::const_iterator i = candidates->begin();
+         i != candidates->end();
+         i++)
+    {
+        if (oif)
         {
-            if (oif)
+            if (oif != m_interfaceCache[(*i)->GetInterface()].m_device)
             {
-                if (oif != m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
+                NS_LOG_LOGIC("Not on requested interface, skipping");
+                continue;
             }
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size() << "Found DGR host route" << *i);
         }
+        allRoutes.push_back(*i);
+        NS_LOG_LOGIC(allRoutes.size() << "Found DGR host route" << *i);
     }
     if (allRoutes.size() > 0) // if route(s) is found
     {
@@ -224,14 +327,8 @@ GBR::LookupECMPRoute(Ipv4Address dest, Ptr<NetDevice> oif)
         }
         RoutingTableEntry* route = allRoutes.at(routRef);
 
-        // create a Ipv4Route object from the selected routing table entry
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(route->GetDest());
-        /// \todo handle multi-address case
-        rtentry->SetSource(m_ipv4->GetAddress(route->GetInterface(), 0).GetLocal());
-        rtentry->SetGateway(route->GetGateway());
-        uint32_t interfaceIdx = route->GetInterface();
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
+        // hand out the Ipv4Route prebuilt for the selected routing table entry
+        rtentry = route->GetIpv4Route();
         return rtentry;
     }
     else
@@ -241,33 +338,21 @@ GBR::LookupECMPRoute(Ipv4Address dest, Ptr<NetDevice> oif)
 }
 
 Ptr<Ipv4Route>
-GBR::LookupDDRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev)
+GBR::LookupDDRRoute(Ipv4Address dest, DdrTag& tag, Ptr<const NetDevice> idev)
 {
     // std::cout <<"DGR routing" << std::endl;
-    BudgetTag bgtTag;
-    TimestampTag timeTag;
-    p->PeekPacketTag(bgtTag);
-    p->PeekPacketTag(timeTag);
     // avoid loop
-    DistTag distTag;
-    uint32_t dist = UINT32_MAX;
-    dist -= 1;
-    if (p->PeekPacketTag(distTag))
-    {
-        dist = distTag.GetDistance();
-    }
+    uint32_t dist = tag.GetDistance();
 
     // budget in microseconds
     uint32_t bgt;
-    if (bgtTag.GetBudget() + timeTag.GetTimestamp().GetMicroSeconds() <
-        Simulator::Now().GetMicroSeconds())
+    if (tag.GetDeadline() < Simulator::Now().GetMicroSeconds())
     {
         bgt = 0;
     }
     else
     {
-        bgt = (bgtTag.GetBudget() + timeTag.GetTimestamp().GetMicroSeconds() -
-               Simulator::Now().GetMicroSeconds());
+        bgt = (tag.GetDeadline() - Simulator::Now().GetMicroSeconds());
     }
     NS_LOG_FUNCTION(this << dest << idev);
     NS_LOG_LOGIC("Looking for route for destination " << dest);
@@ -277,67 +362,75 @@ GBR::LookupDDRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev)
     // typedef std::vector<RoutingTableEntry *>::const_iterator RouteVecCI_t;
     RouteVec_t allRoutes;
 
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    const HostRouteIndex::Candidates* candidates = LookupCandidates(dest);
+    if (candidates == nullptr)
+    {
+        NS_LOG_LOGIC("No host route to " << dest);
+        return 0;
+    }
+    NS_LOG_LOGIC("Number of candidate routes = " << candidates->size());
+    if (!m_interfaceCacheValid)
+    {
+        UpdateInterfaceCache();
+    }
+    for (HostRouteIndex::Candidates::const_iterator i = candidates->begin();
+         i != candidates->end();
+         i++)
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
+        if (idev)
         {
-            if (idev)
+            if (idev == m_interfaceCache[(*i)->GetInterface()].m_device)
             {
-                if (idev == m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
+                NS_LOG_LOGIC("Not on requested interface, skipping");
+                continue;
             }
+        }
 
-            // if interface is down, continue
-            if (!m_ipv4->IsUp((*i)->GetInterface()))
-                continue;
+        const InterfaceCache& local = m_interfaceCache[(*i)->GetInterface()];
+        // if interface is down, continue
+        if (!local.m_up)
+            continue;
 
-            // get the local queue delay in microsecond
-            Ptr<NetDevice> dev_local = m_ipv4->GetNetDevice((*i)->GetInterface());
-            // get the queue disc on the device
-            Ptr<QueueDisc> disc = m_ipv4->GetObject<Node>()
-                                      ->GetObject<TrafficControlLayer>()
-                                      ->GetRootQueueDiscOnDevice(dev_local);
-            Ptr<ValueDenseQueueDisc> dvq = DynamicCast<ValueDenseQueueDisc>(disc);
-            // uint32_t status_local = dvq->GetQueueStatus ();
-            // uint32_t delay_local = status_local * 2000;
-            uint32_t delay_local = dvq->GetQueueDelay();
-
-            // Get the neighbor queue status in microsecond
-            uint32_t delay_neighbor = 0;
-            if ((*i)->GetNextInterface() != 0xffffffff)
-            {
-                uint32_t iface = (*i)->GetInterface();
-                uint32_t niface = (*i)->GetNextInterface();
-                NeighborStatusEntry* entry = m_nsdb.GetNeighborStatusEntry(iface);
-                StatusUnit* su = entry->GetStatusUnit(niface);
-                delay_neighbor = su->GetEstimateDelayDDR();
-                // std::cout << "Neighbor delay: " << delay_neighbor << std::endl;
-            }
-            // in microsecond
-            uint32_t estimate_delay =
-                ((*i)->GetDistance() + 1) * 1000 + delay_local + delay_neighbor;
+        // get the local queue delay in microsecond
+        const Ptr<ValueDenseQueueDisc>& dvq = local.m_qdisc;
+        NS_ASSERT_MSG(dvq, "No ValueDenseQueueDisc on interface " << (*i)->GetInterface());
+        // uint32_t status_local = dvq->GetQueueStatus ();
+        // uint32_t delay_local = status_local * 2000;
+        uint32_t delay_local = dvq->GetQueueDelay();
 
-            if (estimate_delay > bgt)
+        // Get the neighbor queue status in microsecond
+        uint32_t delay_neighbor = 0;
+        if ((*i)->GetNextInterface() != 0xffffffff)
+        {
+            uint32_t iface = (*i)->GetInterface();
+            uint32_t niface = (*i)->GetNextInterface();
+            const NeighborStatusEntry* entry = m_nsdb.GetNeighborStatusEntry(iface);
+            const StatusUnit* su = entry ? entry->GetStatusUnit(niface) : nullptr;
+            if (su)
             {
-                NS_LOG_LOGIC("Too far to the destination, skipping");
-                continue;
+                delay_neighbor = su->GetEstimateDelayDDR();
             }
+            // std::cout << "Neighbor delay: " << delay_neighbor << std::endl;
+        }
+        // in microsecond
+        uint32_t estimate_delay =
+            ((*i)->GetDistance() + 1) * 1000 + delay_local + delay_neighbor;
 
-            if ((*i)->GetDistance() > dist)
-            {
-                NS_LOG_LOGIC("Loop avoidance, skipping");
-                continue;
-            }
+        if (estimate_delay > bgt)
+        {
+            NS_LOG_LOGIC("Too far to the destination, skipping");
+            continue;
+        }
 
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size()
-                         << "Found DGR host route" << *i << " with Cost: " << (*i)->GetDistance());
+        if ((*i)->GetDistance() > dist)
+        {
+            NS_LOG_LOGIC("Loop avoidance, skipping");
+            continue;
         }
+
+        allRoutes.push_back(*i);
+        NS_LOG_LOGIC(allRoutes.size()
+                     << "Found DGR host route" << *i << " with Cost: " << (*i)->GetDistance());
     }
     if (allRoutes.size() > 0) // if route(s) is found
     {
@@ -354,17 +447,9 @@ GBR::LookupDDRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev)
         }
 
         RoutingTableEntry* route = allRoutes.at(selectIndex);
-        uint32_t interfaceIdx = route->GetInterface();
-
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(route->GetDest());
-        /// \todo handle multi-address case
-        rtentry->SetSource(m_ipv4->GetAddress(interfaceIdx, 0).GetLocal());
-        rtentry->SetGateway(route->GetGateway());
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
+        rtentry = route->GetIpv4Route();
 
-        distTag.SetDistance(route->GetDistance());
-        p->ReplacePacketTag(distTag);
+        tag.SetDistance(route->GetDistance());
         return rtentry;
     }
     else
@@ -374,33 +459,21 @@ GBR::LookupDDRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev)
 }
 
 Ptr<Ipv4Route>
-GBR::LookupDGRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev)
+GBR::LookupDGRRoute(Ipv4Address dest, DdrTag& tag, Ptr<const NetDevice> idev)
 {
     // std::cout <<"DGR routing" << std::endl;
-    BudgetTag bgtTag;
-    TimestampTag timeTag;
-    p->PeekPacketTag(bgtTag);
-    p->PeekPacketTag(timeTag);
     // avoid loop
-    DistTag distTag;
-    uint32_t dist = UINT32_MAX;
-    dist -= 1;
-    if (p->PeekPacketTag(distTag))
-    {
-        dist = distTag.GetDistance();
-    }
+    uint32_t dist = tag.GetDistance();
 
     // budget in microseconds
     uint32_t bgt;
-    if (bgtTag.GetBudget() + timeTag.GetTimestamp().GetMicroSeconds() <
-        Simulator::Now().GetMicroSeconds())
+    if (tag.GetDeadline() < Simulator::Now().GetMicroSeconds())
     {
         bgt = 0;
     }
     else
     {
-        bgt = (bgtTag.GetBudget() + timeTag.GetTimestamp().GetMicroSeconds() -
-               Simulator::Now().GetMicroSeconds());
+        bgt = (tag.GetDeadline() - Simulator::Now().GetMicroSeconds());
     }
     NS_LOG_FUNCTION(this << dest << idev);
     NS_LOG_LOGIC("Looking for route for destination " << dest);
@@ -410,65 +483,73 @@ GBR::LookupDGRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev)
     // typedef std::vector<RoutingTableEntry *>::const_iterator RouteVecCI_t;
     RouteVec_t allRoutes;
 
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    const HostRouteIndex::Candidates* candidates = LookupCandidates(dest);
+    if (candidates == nullptr)
+    {
+        NS_LOG_LOGIC("No host route to " << dest);
+        return 0;
+    }
+    NS_LOG_LOGIC("Number of candidate routes = " << candidates->size());
+    if (!m_interfaceCacheValid)
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
+        UpdateInterfaceCache();
+    }
+    for (HostRouteIndex::Candidates::const_iterator i = candidates->begin();
+         i != candidates->end();
+         i++)
+    {
+        if (idev)
         {
-            if (idev)
+            if (idev == m_interfaceCache[(*i)->GetInterface()].m_device)
             {
-                if (idev == m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
+                NS_LOG_LOGIC("Not on requested interface, skipping");
+                continue;
             }
+        }
 
-            // if interface is down, continue
-            if (!m_ipv4->IsUp((*i)->GetInterface()))
-                continue;
+        const InterfaceCache& local = m_interfaceCache[(*i)->GetInterface()];
+        // if interface is down, continue
+        if (!local.m_up)
+            continue;
 
-            // get the local queue delay in microsecond
-            Ptr<NetDevice> dev_local = m_ipv4->GetNetDevice((*i)->GetInterface());
-            // get the queue disc on the device
-            Ptr<QueueDisc> disc = m_ipv4->GetObject<Node>()
-                                      ->GetObject<TrafficControlLayer>()
-                                      ->GetRootQueueDiscOnDevice(dev_local);
-            Ptr<ValueDenseQueueDisc> dvq = DynamicCast<ValueDenseQueueDisc>(disc);
-            // uint32_t status_local = dvq->GetQueueStatus ();
-            // uint32_t delay_local = status_local * 2000;
-            uint32_t delay_local = dvq->GetQueueDelay();
-
-            // Get the neighbor queue status in microsecond
-            uint32_t delay_neighbor = 0;
-            if ((*i)->GetNextInterface() != 0xffffffff)
-            {
-                uint32_t iface = (*i)->GetInterface();
-                uint32_t niface = (*i)->GetNextInterface();
-                NeighborStatusEntry* entry = m_nsdb.GetNeighborStatusEntry(iface);
-                StatusUnit* su = entry->GetStatusUnit(niface);
-                delay_neighbor = su->GetEstimateDelayDGR();
-            }
-            // in microsecond
-            uint32_t estimate_delay = (*i)->GetDistance() * 1000 + delay_local + delay_neighbor;
+        // get the local queue delay in microsecond
+        const Ptr<ValueDenseQueueDisc>& dvq = local.m_qdisc;
+        NS_ASSERT_MSG(dvq, "No ValueDenseQueueDisc on interface " << (*i)->GetInterface());
+        // uint32_t status_local = dvq->GetQueueStatus ();
+        // uint32_t delay_local = status_local * 2000;
+        uint32_t delay_local = dvq->GetQueueDelay();
 
-            if (estimate_delay > bgt)
+        // Get the neighbor queue status in microsecond
+        uint32_t delay_neighbor = 0;
+        if ((*i)->GetNextInterface() != 0xffffffff)
+        {
+            uint32_t iface = (*i)->GetInterface();
+            uint32_t niface = (*i)->GetNextInterface();
+            const NeighborStatusEntry* entry = m_nsdb.GetNeighborStatusEntry(iface);
+            const StatusUnit* su = entry ? entry->GetStatusUnit(niface) : nullptr;
+            if (su)
             {
-                NS_LOG_LOGIC("Too far to the destination, skipping");
-                continue;
+                delay_neighbor = su->GetEstimateDelayDGR();
             }
+        }
+        // in microsecond
+        uint32_t estimate_delay = (*i)->GetDistance() * 1000 + delay_local + delay_neighbor;
 
-            if ((*i)->GetDistance() > dist)
-            {
-                NS_LOG_LOGIC("Loop avoidance, skipping");
-                continue;
-            }
+        if (estimate_delay > bgt)
+        {
+            NS_LOG_LOGIC("Too far to the destination, skipping");
+            continue;
+        }
 
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size()
-                         << "Found DGR host route" << *i << " with Cost: " << (*i)->GetDistance());
+        if ((*i)->GetDistance() > dist)
+        {
+            NS_LOG_LOGIC("Loop avoidance, skipping");
+            continue;
         }
+
+        allRoutes.push_back(*i);
+        NS_LOG_LOGIC(allRoutes.size()
+                     << "Found DGR host route" << *i << " with Cost: " << (*i)->GetDistance());
     }
     if (allRoutes.size() > 0) // if route(s) is found
     {
@@ -476,17 +557,9 @@ GBR::LookupDGRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev)
         uint32_t selectIndex = m_rand->GetInteger(0, allRoutes.size() - 1);
 
         RoutingTableEntry* route = allRoutes.at(selectIndex);
-        uint32_t interfaceIdx = route->GetInterface();
-
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(route->GetDest());
-        /// \todo handle multi-address case
-        rtentry->SetSource(m_ipv4->GetAddress(interfaceIdx, 0).GetLocal());
-        rtentry->SetGateway(route->GetGateway());
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
+        rtentry = route->GetIpv4Route();
 
-        distTag.SetDistance(route->GetDistance());
-        p->ReplacePacketTag(distTag);
+        tag.SetDistance(route->GetDistance());
         return rtentry;
     }
     else
@@ -496,16 +569,10 @@ GBR::LookupDGRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev)
 }
 
 Ptr<Ipv4Route>
-GBR::LookupKShortRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev)
+GBR::LookupKShortRoute(Ipv4Address dest, DdrTag& tag, Ptr<const NetDevice> idev)
 {
     // avoid loop
-    DistTag distTag;
-    uint32_t dist = UINT32_MAX;
-    dist -= 1;
-    if (p->PeekPacketTag(distTag))
-    {
-        dist = distTag.GetDistance();
-    }
+    uint32_t dist = tag.GetDistance();
 
     NS_LOG_FUNCTION(this << dest << idev);
     NS_LOG_LOGIC("Looking for route for destination " << dest);
@@ -515,47 +582,47 @@ GBR::LookupKShortRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> ide
     // typedef std::vector<RoutingTableEntry *>::const_iterator RouteVecCI_t;
     RouteVec_t allRoutes;
 
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    const HostRouteIndex::Candidates* candidates = LookupCandidates(dest);
+    if (candidates == nullptr)
+    {
+        NS_LOG_LOGIC("No host route to " << dest);
+        return 0;
+    }
+    NS_LOG_LOGIC("Number of candidate routes = " << candidates->size());
+    if (!m_interfaceCacheValid)
+    {
+        UpdateInterfaceCache();
+    }
+    for (HostRouteIndex::Candidates::const_iterator i = candidates->begin();
+         i != candidates->end();
+         i++)
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
+        if (idev)
         {
-            if (idev)
+            if (idev == m_interfaceCache[(*i)->GetInterface()].m_device)
             {
-                if (idev == m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
-            }
-            if ((*i)->GetDistance() > dist)
-            {
-                NS_LOG_LOGIC("Loop avoidance, skipping");
+                NS_LOG_LOGIC("Not on requested interface, skipping");
                 continue;
             }
-
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size()
-                         << "Found route" << *i << " with Cost: " << (*i)->GetDistance());
         }
+        if ((*i)->GetDistance() > dist)
+        {
+            NS_LOG_LOGIC("Loop avoidance, skipping");
+            continue;
+        }
+
+        allRoutes.push_back(*i);
+        NS_LOG_LOGIC(allRoutes.size()
+                     << "Found route" << *i << " with Cost: " << (*i)->GetDistance());
     }
     if (allRoutes.size() > 0) // if route(s) is found
     {
         // random select
         uint32_t selectIndex = m_rand->GetInteger(0, allRoutes.size() - 1);
         RoutingTableEntry* route = allRoutes.at(selectIndex);
-        uint32_t interfaceIdx = route->GetInterface();
+        rtentry = route->GetIpv4Route();
 
-        rtentry = Create<Ipv4Route>();
-        rtentry->SetDestination(route->GetDest());
-        /// \todo handle multi-address case
-        rtentry->SetSource(m_ipv4->GetAddress(interfaceIdx, 0).GetLocal());
-        rtentry->SetGateway(route->GetGateway());
-        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
-
-        distTag.SetDistance(route->GetDistance());
-        p->ReplacePacketTag(distTag);
+        tag.SetDistance(route->GetDistance());
         return rtentry;
     }
     else
@@ -708,6 +775,31 @@ GBR::LookupKShortRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> ide
 //     }
 // }
 
+uint64_t
+GBR::GetNStatusUpdatePackets(void) const
+{
+    return m_nUpdatePackets;
+}
+
+uint64_t
+GBR::GetNStatusUpdateBytes(void) const
+{
+    return m_nUpdateBytes;
+}
+
+uint64_t
+GBR::GetNPeriodicStatusUpdatePackets(void) const
+{
+    // periodic updates are only counted apart in triggered mode
+    return m_updateMode == PERIODIC_UPDATE ? m_nUpdatePackets : m_nPeriodicUpdatePackets;
+}
+
+uint64_t
+GBR::GetNPeriodicStatusUpdateBytes(void) const
+{
+    return m_updateMode == PERIODIC_UPDATE ? m_nUpdateBytes : m_nPeriodicUpdateBytes;
+}
+
 uint32_t
 GBR::GetNRoutes(void) const
 {
@@ -775,6 +867,7 @@ GBR::RemoveRoute(uint32_t index)
             if (tmp == index)
             {
                 NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
+                m_hostRouteIndex.Remove(*i);
                 delete *i;
                 m_hostRoutes.erase(i);
                 NS_LOG_LOGIC("Done removing host route "
@@ -830,6 +923,8 @@ GBR::DoDispose(void)
 {
     NS_LOG_FUNCTION(this);
     // TODO: Realise memorys
+    m_hostRouteIndex.Clear();
+    m_hostRouteIndex.SetAliases(nullptr);
     for (HostRoutesI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i = m_hostRoutes.erase(i))
     {
         delete (*i);
@@ -844,6 +939,12 @@ GBR::DoDispose(void)
     {
         delete (*l);
     }
+    m_nextUnsolicitedUpdate.Cancel();
+    m_nextTriggeredUpdate.Cancel();
+    m_centralSampling = false;
+    // the oracle neighbors hold their routing protocols
+    m_interfaceCache.clear();
+    m_interfaceCacheValid = false;
 
     Ipv4RoutingProtocol::DoDispose();
 }
@@ -854,10 +955,25 @@ GBR::DoInitialize()
     NS_LOG_FUNCTION(this);
     // bool addedGlobal = false;
     m_initialized = true;
+    UpdateInterfaceCache();
+    m_nsdb.Initialize(m_ipv4->GetNInterfaces());
 
-    // To Check: An random value is needed to initialize the protocol?
-    Time delay = m_unsolicitedUpdate;
-    m_nextUnsolicitedUpdate = Simulator::Schedule(delay, &GBR::SendUnsolicitedUpdate, this);
+    // DoInitialize runs again whenever every route is recomputed: keep the
+    // sampling of the neighbor status going at its own pace
+    if (StatusSampler::IsEnabled())
+    {
+        if (!m_centralSampling)
+        {
+            m_centralSampling = true;
+            SimulationSingleton<StatusSampler>::Get()->Register(this, m_unsolicitedUpdate);
+        }
+    }
+    else if (!m_nextUnsolicitedUpdate.IsRunning())
+    {
+        // To Check: An random value is needed to initialize the protocol?
+        Time delay = m_unsolicitedUpdate;
+        m_nextUnsolicitedUpdate = Simulator::Schedule(delay, &GBR::SendUnsolicitedUpdate, this);
+    }
 
     uint32_t nodeId = m_ipv4->GetNetDevice(1)->GetNode()->GetId();
     std::stringstream ss;
@@ -868,8 +984,6 @@ GBR::DoInitialize()
     // m_outStream = Create<OutputStreamWrapper> ("Node" + strNodeId + "queueStatusErr.txt",
     // std::ios::out);
 
-    m_nextUnsolicitedUpdate = Simulator::Schedule(delay, &GBR::SendUnsolicitedUpdate, this);
-
     // Initialize the sockets for every netdevice
     for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
     {
@@ -879,6 +993,22 @@ GBR::DoInitialize()
             continue;
         }
 
+        // the sockets of an interface are bound once, binding them again fails
+        bool hasSocket = false;
+        for (SocketListCI iter = m_unicastSocketList.begin(); iter != m_unicastSocketList.end();
+             iter++)
+        {
+            if (iter->second == i)
+            {
+                hasSocket = true;
+                break;
+            }
+        }
+        if (hasSocket)
+        {
+            continue;
+        }
+
         bool activeInterface = false;
         if (m_interfaceExclusions.find(i) == m_interfaceExclusions.end())
         {
@@ -1033,31 +1163,41 @@ GBR::RouteOutput(Ptr<Packet> p,
     //
     NS_LOG_LOGIC("Delay-Guarenteed destination- looking up");
     Ptr<Ipv4Route> rtentry;
-    BudgetTag budgetTag;
-    if (!p)
+    DdrTag ddrTag;
+    bool hasDdrTag = false;
+    if (p)
     {
-        rtentry = LookupECMPRoute(header.GetDestination(), oif);
+        hasDdrTag = p->PeekPacketTag(ddrTag);
+        if (!hasDdrTag)
+        {
+            ddrTag.PeekLegacyTags(p);
+        }
     }
-    else if (p->PeekPacketTag(budgetTag))
+    if (ddrTag.HasBudget())
     {
+        uint32_t dist = ddrTag.GetDistance();
         switch (m_routeSelectMode)
         {
         case NONE:
             rtentry = LookupECMPRoute(header.GetDestination(), oif);
             break;
         case KSHORT:
-            rtentry = LookupKShortRoute(header.GetDestination(), p, oif);
+            rtentry = LookupKShortRoute(header.GetDestination(), ddrTag, oif);
             break;
         case DGR:
-            rtentry = LookupDGRRoute(header.GetDestination(), p, oif);
+            rtentry = LookupDGRRoute(header.GetDestination(), ddrTag, oif);
             break;
         case DDR:
-            rtentry = LookupDDRRoute(header.GetDestination(), p, oif);
+            rtentry = LookupDDRRoute(header.GetDestination(), ddrTag, oif);
             break;
         default:
             rtentry = LookupECMPRoute(header.GetDestination(), oif);
         }
         // rtentry = LookupDGRRoute (header.GetDestination (), p, oif);
+        if (rtentry && ddrTag.GetDistance() != dist)
+        {
+            SetPacketDistance(p, ddrTag, hasDdrTag);
+        }
     }
     else
     {
@@ -1121,29 +1261,36 @@ GBR::RouteInput(Ptr<const Packet> p,
     // Next, try to find a route
     NS_LOG_LOGIC("Unicast destination- looking up global route");
     Ptr<Ipv4Route> rtentry;
-    BudgetTag budgetTag;
-    Ptr<Packet> p_copy;
-    if (p->PeekPacketTag(budgetTag))
+    DdrTag ddrTag;
+    bool hasDdrTag = p->PeekPacketTag(ddrTag);
+    if (!hasDdrTag)
+    {
+        ddrTag.PeekLegacyTags(p);
+    }
+    // The lookups only read the tag; the packet is copied once, and only if
+    // the distance it carries has to be updated.
+    bool updateDistance = false;
+    if (ddrTag.HasBudget())
     {
-        p_copy = p->Copy();
+        uint32_t dist = ddrTag.GetDistance();
         switch (m_routeSelectMode)
         {
         case NONE:
             rtentry = LookupECMPRoute(header.GetDestination());
             break;
         case KSHORT:
-            rtentry = LookupKShortRoute(header.GetDestination(), p_copy, idev);
+            rtentry = LookupKShortRoute(header.GetDestination(), ddrTag, idev);
             break;
         case DGR:
-            rtentry = LookupDGRRoute(header.GetDestination(), p_copy, idev);
+            rtentry = LookupDGRRoute(header.GetDestination(), ddrTag, idev);
             break;
         case DDR:
-            rtentry = LookupDDRRoute(header.GetDestination(), p_copy, idev);
+            rtentry = LookupDDRRoute(header.GetDestination(), ddrTag, idev);
             break;
         default:
             rtentry = LookupECMPRoute(header.GetDestination());
         }
-        // rtentry = LookupDGRRoute (header.GetDestination (), p_copy, idev);
+        updateDistance = (ddrTag.GetDistance() != dist);
     }
     else
     {
@@ -1152,9 +1299,11 @@ GBR::RouteInput(Ptr<const Packet> p,
     if (rtentry)
     {
         // std::cout << "find a way" << std::endl;
-        if (p_copy)
+        if (updateDistance)
         {
-            p = p_copy->Copy();
+            Ptr<Packet> p_copy = p->Copy();
+            SetPacketDistance(p_copy, ddrTag, hasDdrTag);
+            p = p_copy;
         }
         NS_LOG_LOGIC("Found unicast destination- calling unicast callback");
         ucb(rtentry, p, header);
@@ -1168,15 +1317,30 @@ GBR::RouteInput(Ptr<const Packet> p,
     }
 }
 
+void
+GBR::SetPacketDistance(Ptr<Packet> p, DdrTag& tag, bool hasDdrTag)
+{
+    NS_LOG_FUNCTION(this << p << tag.GetDistance() << hasDdrTag);
+    if (hasDdrTag)
+    {
+        p->ReplacePacketTag(tag);
+    }
+    else
+    {
+        DistTag distTag;
+        distTag.SetDistance(tag.GetDistance());
+        p->ReplacePacketTag(distTag);
+    }
+}
+
 void
 GBR::NotifyInterfaceUp(uint32_t i)
 {
     NS_LOG_FUNCTION(this << i);
+    m_interfaceCacheValid = false;
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildRoutingDatabase();
-        RouteManager::InitializeRoutes();
+        RouteManager::ScheduleUpdateRoutes();
     }
 }
 
@@ -1184,11 +1348,10 @@ void
 GBR::NotifyInterfaceDown(uint32_t i)
 {
     NS_LOG_FUNCTION(this << i);
+    m_interfaceCacheValid = false;
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildRoutingDatabase();
-        RouteManager::InitializeRoutes();
+        RouteManager::ScheduleUpdateRoutes();
     }
 }
 
@@ -1196,11 +1359,10 @@ void
 GBR::NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address)
 {
     NS_LOG_FUNCTION(this << interface << address);
+    m_interfaceCacheValid = false;
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildRoutingDatabase();
-        RouteManager::InitializeRoutes();
+        RouteManager::ScheduleUpdateRoutes();
     }
 }
 
@@ -1208,11 +1370,10 @@ void
 GBR::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address)
 {
     NS_LOG_FUNCTION(this << interface << address);
+    m_interfaceCacheValid = false;
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        RouteManager::DeleteRoutes();
-        RouteManager::BuildRoutingDatabase();
-        RouteManager::InitializeRoutes();
+        RouteManager::ScheduleUpdateRoutes();
     }
 }
 
@@ -1224,6 +1385,96 @@ GBR::SetIpv4(Ptr<Ipv4> ipv4)
     m_ipv4 = ipv4;
 }
 
+void
+GBR::UpdateInterfaceCache(void)
+{
+    NS_LOG_FUNCTION(this);
+    Ptr<TrafficControlLayer> tc = m_ipv4->GetObject<Node>()->GetObject<TrafficControlLayer>();
+    m_interfaceCache.resize(m_ipv4->GetNInterfaces());
+    // size of an update packet, but for its NSEs, and of an NSE
+    DgrHeader hdr;
+    hdr.SetVersion(m_headerVersion);
+    m_updateOverhead = Ipv4Header().GetSerializedSize() + UdpHeader().GetSerializedSize() +
+                       hdr.GetSerializedSize();
+    m_updateNseSize = hdr.GetNseSize();
+    m_nUpdateNses = 0;
+    for (uint32_t i = 0; i < m_interfaceCache.size(); i++)
+    {
+        InterfaceCache& cache = m_interfaceCache[i];
+        cache.m_device = m_ipv4->GetNetDevice(i);
+        cache.m_loopback = false;
+        if (DynamicCast<LoopbackNetDevice>(cache.m_device))
+        {
+            cache.m_loopback = true;
+        }
+        cache.m_qdisc = nullptr;
+        if (tc && !cache.m_loopback)
+        {
+            cache.m_qdisc =
+                DynamicCast<ValueDenseQueueDisc>(tc->GetRootQueueDiscOnDevice(cache.m_device));
+        }
+        cache.m_up = m_ipv4->IsUp(i);
+        cache.m_sentState = -1;
+        if (cache.m_up && !cache.m_loopback)
+        {
+            m_nUpdateNses++;
+        }
+        cache.m_maxUpdateNses = 1;
+        if (m_ipv4->GetMtu(i) > m_updateOverhead + m_updateNseSize)
+        {
+            cache.m_maxUpdateNses = (m_ipv4->GetMtu(i) - m_updateOverhead) / m_updateNseSize;
+        }
+        cache.m_local = Ipv4Address();
+        if (m_ipv4->GetNAddresses(i) > 0)
+        {
+            /// \todo handle multi-address case
+            cache.m_local = m_ipv4->GetAddress(i, 0).GetLocal();
+        }
+        cache.m_neighbors.clear();
+        if (m_stateDelivery == ORACLE_DELIVERY && !cache.m_loopback)
+        {
+            UpdateOracleNeighbors(cache);
+        }
+    }
+    m_interfaceCacheValid = true;
+
+    // Source addresses and devices may have changed, so replace the routes
+    // handed out by the lookups.  Routes already attached to packets in
+    // flight are left untouched.
+    for (HostRoutesI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    {
+        BuildIpv4Route(*i);
+    }
+    for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+    {
+        BuildIpv4Route(*j);
+    }
+    for (ASExternalRoutesI k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
+    {
+        BuildIpv4Route(*k);
+    }
+}
+
+void
+GBR::BuildIpv4Route(RoutingTableEntry* route)
+{
+    NS_LOG_FUNCTION(this << route);
+    if (!m_interfaceCacheValid)
+    {
+        UpdateInterfaceCache();
+    }
+    uint32_t interfaceIdx = route->GetInterface();
+    NS_ASSERT_MSG(interfaceIdx < m_interfaceCache.size(), "Unknown interface " << interfaceIdx);
+
+    Ptr<Ipv4Route> rtentry = Create<Ipv4Route>();
+    rtentry->SetDestination(route->GetDest());
+    /// \todo handle multi-address case
+    rtentry->SetSource(m_interfaceCache[interfaceIdx].m_local);
+    rtentry->SetGateway(route->GetGateway());
+    rtentry->SetOutputDevice(m_interfaceCache[interfaceIdx].m_device);
+    route->SetIpv4Route(rtentry);
+}
+
 void
 GBR::Receive(Ptr<Socket> socket)
 {
@@ -1270,14 +1521,17 @@ GBR::Receive(Ptr<Socket> socket)
         return;
     }
 
+    // The NSEs of a response are applied as the header is parsed.
     DgrHeader hdr;
+    ResponseVisitor visitor(this, ipInterfaceIndex);
+    hdr.SetNseVisitor(&visitor);
     packet->RemoveHeader(hdr);
 
     if (hdr.GetCommand() == DgrHeader::RESPONSE)
     {
         NS_LOG_LOGIC("The message is a Response from " << senderAddr.GetIpv4() << ":"
-                                                       << senderAddr.GetPort());
-        HandleResponses(hdr, senderAddress, ipInterfaceIndex, hopLimit);
+                                                       << senderAddr.GetPort() << ", hop limit "
+                                                       << int(hopLimit));
     }
     // else if (hdr.GetCommand () == DgrHeader::REQUEST)
     //   {
@@ -1296,125 +1550,356 @@ void
 GBR::SendUnsolicitedUpdate()
 {
     NS_LOG_FUNCTION(this);
-    if (m_nextTriggeredUpdate.IsRunning())
-    {
-        m_nextTriggeredUpdate.Cancel();
-    }
-    DoSendNeighborStatusUpdate(true);
+    DoSampleNeighborStatus();
     // todo : update the delay, do we need some random in the delay
     Time delay = m_unsolicitedUpdate;
     m_nextUnsolicitedUpdate = Simulator::Schedule(delay, &GBR::SendUnsolicitedUpdate, this);
 }
 
+bool
+GBR::SampleNeighborStatus(void)
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_centralSampling)
+    {
+        return false;
+    }
+    DoSampleNeighborStatus();
+    return true;
+}
+
+void
+GBR::DoSampleNeighborStatus()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_updateMode == TRIGGERED_UPDATE)
+    {
+        CountPeriodicUpdate();
+    }
+    if (m_updateMode == PERIODIC_UPDATE ||
+        Simulator::Now() - m_lastFullUpdate >= m_fullUpdatePeriod)
+    {
+        if (m_nextTriggeredUpdate.IsRunning())
+        {
+            m_nextTriggeredUpdate.Cancel();
+        }
+        DoSendNeighborStatusUpdate(true);
+        m_lastFullUpdate = Simulator::Now();
+        m_lastTriggeredUpdate = Simulator::Now();
+    }
+    else if (!m_nextTriggeredUpdate.IsRunning() && HasStatusChanges())
+    {
+        Time delay = m_lastTriggeredUpdate + m_minTriggeredUpdateInterval - Simulator::Now();
+        if (delay.IsStrictlyPositive())
+        {
+            m_nextTriggeredUpdate =
+                Simulator::Schedule(delay, &GBR::SendTriggeredNeighborStatusUpdate, this);
+        }
+        else
+        {
+            SendTriggeredNeighborStatusUpdate();
+        }
+    }
+}
+
+void
+GBR::SendTriggeredNeighborStatusUpdate()
+{
+    NS_LOG_FUNCTION(this);
+    DoSendNeighborStatusUpdate(false);
+    m_lastTriggeredUpdate = Simulator::Now();
+}
+
+bool
+GBR::HasStatusChanges(void)
+{
+    if (!m_interfaceCacheValid)
+    {
+        UpdateInterfaceCache();
+    }
+    for (uint32_t i = 0; i < m_interfaceCache.size(); i++)
+    {
+        const InterfaceCache& cache = m_interfaceCache[i];
+        if (!cache.m_up || cache.m_loopback)
+        {
+            continue;
+        }
+        NS_ASSERT_MSG(cache.m_qdisc, "No ValueDenseQueueDisc on interface " << i);
+        if (static_cast<int>(cache.m_qdisc->GetQueueStatus()) != cache.m_sentState)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+GBR::CountPeriodicUpdate(void)
+{
+    if (!m_interfaceCacheValid)
+    {
+        UpdateInterfaceCache();
+    }
+    if (m_nUpdateNses == 0)
+    {
+        return;
+    }
+    for (SocketListCI iter = m_unicastSocketList.begin(); iter != m_unicastSocketList.end();
+         iter++)
+    {
+        uint32_t interface = iter->second;
+        if (m_interfaceExclusions.find(interface) != m_interfaceExclusions.end())
+        {
+            continue;
+        }
+        uint32_t maxNse = m_interfaceCache[interface].m_maxUpdateNses;
+        uint32_t nPackets = (m_nUpdateNses + maxNse - 1) / maxNse;
+        m_nPeriodicUpdatePackets += nPackets;
+        m_nPeriodicUpdateBytes += nPackets * m_updateOverhead + m_nUpdateNses * m_updateNseSize;
+    }
+}
+
+void
+GBR::UpdateOracleNeighbors(InterfaceCache& cache)
+{
+    NS_LOG_FUNCTION(this << cache.m_device);
+    Ptr<Channel> channel = cache.m_device->GetChannel();
+    if (!channel)
+    {
+        return;
+    }
+    TimeValue delay(Seconds(0));
+    channel->GetAttributeFailSafe("Delay", delay);
+    for (std::size_t j = 0; j < channel->GetNDevices(); j++)
+    {
+        Ptr<NetDevice> device = channel->GetDevice(j);
+        if (device == cache.m_device)
+        {
+            continue;
+        }
+        Ptr<Node> node = device->GetNode();
+        Ptr<Router> rtr = node->GetObject<Router>();
+        Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+        if (!rtr || !rtr->GetRoutingProtocol() || !ipv4)
+        {
+            NS_LOG_LOGIC("No GBR router behind device " << device);
+            continue;
+        }
+        int32_t interface = ipv4->GetInterfaceForDevice(device);
+        if (interface < 0)
+        {
+            continue;
+        }
+        OracleNeighbor neighbor;
+        neighbor.m_gbr = rtr->GetRoutingProtocol();
+        neighbor.m_nodeId = node->GetId();
+        neighbor.m_interface = interface;
+        neighbor.m_delay = delay.Get();
+        cache.m_neighbors.push_back(neighbor);
+    }
+}
+
 void
 GBR::DoSendNeighborStatusUpdate(bool periodic)
 {
     NS_LOG_FUNCTION(this << (periodic ? " periodic" : " triggered"));
+    if (!m_interfaceCacheValid)
+    {
+        UpdateInterfaceCache();
+    }
+
+    // Every interface sends the same NSEs: snapshot the states once.
+    std::vector<DgrNse> nses;
+    nses.reserve(m_interfaceCache.size());
+    for (uint32_t i = 0; i < m_interfaceCache.size(); i++)
+    {
+        InterfaceCache& cache = m_interfaceCache[i];
+        if (!cache.m_up || cache.m_loopback)
+        {
+            continue;
+        }
+        // get the queue disc on device
+        const Ptr<ValueDenseQueueDisc>& qdisc = cache.m_qdisc;
+        NS_ASSERT_MSG(qdisc, "No ValueDenseQueueDisc on interface " << i);
+        uint32_t state = qdisc->GetQueueStatus();
+        if (!periodic && static_cast<int>(state) == cache.m_sentState)
+        {
+            continue;
+        }
+        cache.m_sentState = state;
+        DgrNse nse;
+        nse.SetInterface(i);
+        nse.SetState(state);
+        nses.push_back(nse);
+    }
+    if (nses.empty())
+    {
+        return;
+    }
+    if (m_stateDelivery == ORACLE_DELIVERY)
+    {
+        DeliverNeighborStatusUpdate(nses);
+        return;
+    }
+
+    // The packets are only rebuilt for an interface with another MTU.
+    uint32_t ipUdpSize = Ipv4Header().GetSerializedSize() + UdpHeader().GetSerializedSize();
+    std::vector<Ptr<Packet>> packets;
+    uint16_t packetsMtu = 0;
     for (SocketListI iter = m_unicastSocketList.begin(); iter != m_unicastSocketList.end(); iter++)
     {
         uint32_t interface = iter->second;
-        if (m_interfaceExclusions.find(interface) == m_interfaceExclusions.end())
+        if (m_interfaceExclusions.find(interface) != m_interfaceExclusions.end())
         {
-            uint16_t mtu = m_ipv4->GetMtu(interface);
-            uint16_t maxNse = (mtu - Ipv4Header().GetSerializedSize() -
-                               UdpHeader().GetSerializedSize() - DgrHeader().GetSerializedSize()) /
-                              DgrNse().GetSerializedSize();
-            Ptr<Packet> p = Create<Packet>();
-            SocketIpTtlTag ttlTag;
-            ttlTag.SetTtl(1);
-            p->AddPacketTag(ttlTag);
-
-            DgrHeader hdr;
-            hdr.SetCommand(DgrHeader::RESPONSE);
-            // Find the Status of every netdevice and put it in
-            // TODO: Finish this function when finish the NSE definiation
-            for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
-            {
-                if (!m_ipv4->IsUp(i))
-                    continue;
-                Ptr<LoopbackNetDevice> check =
-                    DynamicCast<LoopbackNetDevice>(m_ipv4->GetNetDevice(i));
-                if (check)
-                {
-                    continue;
-                }
-                // get the device
-                Ptr<NetDevice> dev = m_ipv4->GetNetDevice(i);
-                // get the queue disc on devic
-                Ptr<QueueDisc> disc = m_ipv4->GetObject<Node>()
-                                          ->GetObject<TrafficControlLayer>()
-                                          ->GetRootQueueDiscOnDevice(dev);
-                Ptr<ValueDenseQueueDisc> qdisc = DynamicCast<ValueDenseQueueDisc>(disc);
-                DgrNse nse;
-                nse.SetInterface(i);
-                nse.SetState(qdisc->GetQueueStatus());
-                hdr.AddNse(nse);
-                if (hdr.GetNseNumber() == maxNse)
-                {
-                    p->AddHeader(hdr);
-                    NS_LOG_DEBUG("SendTo: " << *p);
-                    iter->first->SendTo(
-                        p,
-                        0,
-                        InetSocketAddress(DGR_BROAD_CAST,
-                                          DGR_PORT)); // Todo : defind the port for DGR routing
-                    p->RemoveHeader(hdr);
-                    hdr.ClearNses();
-                }
-            }
-            if (hdr.GetNseNumber() > 0)
-            {
-                p->AddHeader(hdr);
-                NS_LOG_DEBUG("SendTo: " << *p);
-                iter->first->SendTo(
-                    p,
-                    0,
-                    InetSocketAddress(DGR_BROAD_CAST, DGR_PORT)); // Todo: Defined the DGR port
-            }
+            continue;
+        }
+        uint16_t mtu = m_ipv4->GetMtu(interface);
+        if (packets.empty() || mtu != packetsMtu)
+        {
+            BuildStatusUpdatePackets(nses, mtu - ipUdpSize, packets);
+            packetsMtu = mtu;
+        }
+        for (uint32_t j = 0; j < packets.size(); j++)
+        {
+            m_nUpdatePackets++;
+            m_nUpdateBytes += packets[j]->GetSize() + ipUdpSize;
+            NS_LOG_DEBUG("SendTo: " << *packets[j]);
+            iter->first->SendTo(
+                packets[j]->Copy(),
+                0,
+                InetSocketAddress(DGR_BROAD_CAST, DGR_PORT)); // Todo: Defined the DGR port
         }
     }
 }
 
 void
-GBR::HandleResponses(DgrHeader hdr,
-                     Ipv4Address senderAddress,
-                     uint32_t incomingInterface,
-                     uint8_t hopLimit)
+GBR::BuildStatusUpdatePackets(const std::vector<DgrNse>& nses,
+                              uint32_t maxSize,
+                              std::vector<Ptr<Packet>>& packets)
 {
-    NS_LOG_FUNCTION(this << senderAddress << incomingInterface << int(hopLimit) << hdr);
-    if (m_interfaceExclusions.find(incomingInterface) != m_interfaceExclusions.end())
+    NS_LOG_FUNCTION(this << nses.size() << maxSize);
+    packets.clear();
+    DgrHeader hdr;
+    hdr.SetCommand(DgrHeader::RESPONSE);
+    hdr.SetVersion(m_headerVersion);
+    for (uint32_t i = 0; i < nses.size(); i++)
+    {
+        hdr.AddNse(nses[i]);
+        if (i + 1 < nses.size() && hdr.GetSerializedSize() + hdr.GetNseSize() <= maxSize)
+        {
+            continue;
+        }
+        Ptr<Packet> p = Create<Packet>();
+        SocketIpTtlTag ttlTag;
+        ttlTag.SetTtl(1);
+        p->AddPacketTag(ttlTag);
+        p->AddHeader(hdr);
+        packets.push_back(p);
+        hdr.ClearNses();
+    }
+}
+
+void
+GBR::DeliverNeighborStatusUpdate(const std::vector<DgrNse>& nses)
+{
+    NS_LOG_FUNCTION(this << nses.size());
+    for (uint32_t i = 0; i < m_interfaceCache.size(); i++)
+    {
+        const InterfaceCache& cache = m_interfaceCache[i];
+        if (!cache.m_up || cache.m_loopback ||
+            m_interfaceExclusions.find(i) != m_interfaceExclusions.end())
+        {
+            continue;
+        }
+        for (uint32_t j = 0; j < cache.m_neighbors.size(); j++)
+        {
+            const OracleNeighbor& neighbor = cache.m_neighbors[j];
+            Simulator::ScheduleWithContext(neighbor.m_nodeId,
+                                           neighbor.m_delay,
+                                           &GBR::ReceiveNeighborStatusUpdate,
+                                           neighbor.m_gbr,
+                                           neighbor.m_interface,
+                                           nses);
+        }
+    }
+}
+
+void
+GBR::ReceiveNeighborStatusUpdate(uint32_t incomingInterface, std::vector<DgrNse> nses)
+{
+    NS_LOG_FUNCTION(this << incomingInterface << nses.size());
+    // a packet is not received on an interface that is down either
+    if (!m_ipv4 || !m_ipv4->IsUp(incomingInterface))
     {
-        NS_LOG_LOGIC(
-            "Ignoring an update message from an excluded interface: " << incomingInterface);
         return;
     }
-    if (hdr.GetSerializedSize() == 4)
+    NeighborStatusEntry* entry = HandleResponses(incomingInterface);
+    if (!entry)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < nses.size(); i++)
+    {
+        HandleNse(entry, nses[i].GetInterface(), nses[i].GetState());
+    }
+}
+
+GBR::ResponseVisitor::ResponseVisitor(GBR* gbr, uint32_t incomingInterface)
+    : m_gbr(gbr),
+      m_incomingInterface(incomingInterface),
+      m_entry(nullptr)
+{
+}
+
+bool
+GBR::ResponseVisitor::VisitCommand(DgrHeader::Command_e command)
+{
+    if (command != DgrHeader::RESPONSE)
     {
-        NS_LOG_LOGIC("Ignoring an update message without neighbor state entries!");
+        return false;
     }
+    m_entry = m_gbr->HandleResponses(m_incomingInterface);
+    return m_entry != nullptr;
+}
+
+void
+GBR::ResponseVisitor::VisitNse(uint32_t iface, uint32_t state)
+{
+    m_gbr->HandleNse(m_entry, iface, state);
+}
 
-    NeighborStatusEntry* entry = m_nsdb.HandleNeighborStatusEntry(incomingInterface);
-    if (entry == nullptr)
+NeighborStatusEntry*
+GBR::HandleResponses(uint32_t incomingInterface)
+{
+    NS_LOG_FUNCTION(this << incomingInterface);
+    if (m_interfaceExclusions.find(incomingInterface) != m_interfaceExclusions.end())
     {
-        entry = new NeighborStatusEntry();
-        m_nsdb.Insert(incomingInterface, entry);
+        NS_LOG_LOGIC(
+            "Ignoring an update message from an excluded interface: " << incomingInterface);
+        return nullptr;
     }
+    return m_nsdb.HandleNeighborStatusEntry(incomingInterface);
+}
 
-    std::list<DgrNse> nses = hdr.GetNseList();
-    for (std::list<DgrNse>::iterator iter = nses.begin(); iter != nses.end(); iter++)
+void
+GBR::HandleNse(NeighborStatusEntry* entry, uint32_t iface, uint32_t state)
+{
+    StatusUnit* su = entry->HandleStatusUnit(iface);
+    if (m_updateMode == TRIGGERED_UPDATE)
     {
-        uint32_t n_iface = (*iter).GetInterface();
-        int n_state = (*iter).GetState();
-        StatusUnit* su = entry->GetStatusUnit(n_iface);
-        if (su == nullptr)
+        // The states that did not change were not sent: count the
+        // sample periods they lasted.
+        uint32_t nSamples = 1;
+        Time elapsed = Simulator::Now() - su->GetLastUpdate();
+        if (elapsed > m_unsolicitedUpdate)
         {
-            su = new StatusUnit();
-            entry->Insert(n_iface, su);
+            nSamples = elapsed.GetInteger() / m_unsolicitedUpdate.GetInteger();
         }
-        su->Update(n_state);
-        // std::ostream* os = m_outStream->GetStream ();
-        // *os << "Iface: " << n_iface << " Predict Err: " << abs(n_state - su->GetCurrentState ())
-        // << std::endl; Print the su su->Print (std::cout);
+        su->Update(state, nSamples);
+    }
+    else
+    {
+        su->Update(state);
     }
 }
 
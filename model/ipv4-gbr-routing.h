@@ -20,10 +20,13 @@
 #ifndef IPV4_GBR_ROUTING_H
 #define IPV4_GBR_ROUTING_H
 
+#include "host-route-index.h"
 #include "neighbor-status-database.h"
 #include "packet-headers.h"
+#include "packet-tags.h"
 #include "route-manager-impl.h"
 #include "routing-table-entry.h"
+#include "value-dense-queue-disc.h"
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -36,6 +39,7 @@
 #include <list>
 #include <map>
 #include <stdint.h>
+#include <vector>
 
 namespace ns3
 {
@@ -57,6 +61,18 @@ typedef enum
     DDR
 } RouteSelectMode_t;
 
+typedef enum
+{
+    PERIODIC_UPDATE, //!< send every neighbor state every sample period
+    TRIGGERED_UPDATE //!< send the neighbor states that changed, rate limited
+} UpdateMode_t;
+
+typedef enum
+{
+    PACKET_DELIVERY, //!< send the neighbor states in UDP packets through the IP stack
+    ORACLE_DELIVERY  //!< hand the neighbor states to the neighbors after the link delay
+} StateDelivery_t;
+
 /**
  * \ingroup ipv4
  *
@@ -202,6 +218,61 @@ class GBR : public Ipv4RoutingProtocol
                               Ipv4Address nextHop,
                               uint32_t interface);
 
+    /**
+     * \brief Check whether the table has a host route to a destination
+     * through a next hop.
+     *
+     * \param dest The destination the route was added with.
+     * \param nextHop The next hop Ipv4Address
+     * \param interface The network interface index.
+     * \return true if such a route is in the table
+     */
+    bool HasHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface) const;
+
+    /**
+     * \brief Set the address to router ID map of a compressed routing table.
+     *
+     * A compressed table keys its host routes by the router ID of the
+     * destination, so the lookups first map the destination address to the
+     * router owning it.  The Ipv4Route handed out then has the router ID as
+     * its destination.  The map is shared by every router and owned by the
+     * route manager.
+     *
+     * \param aliases the map, or a null pointer for a table keyed by address
+     */
+    void SetHostRouteAliases(const HostRouteIndex::Aliases* aliases);
+
+    /**
+     * \return the number of neighbor status update packets sent
+     */
+    uint64_t GetNStatusUpdatePackets(void) const;
+    /**
+     * \return the size of the neighbor status update packets sent, UDP and
+     * IPv4 headers included, in bytes
+     */
+    uint64_t GetNStatusUpdateBytes(void) const;
+    /**
+     * \return the number of neighbor status update packets the periodic
+     * updates would have sent over the same time
+     */
+    uint64_t GetNPeriodicStatusUpdatePackets(void) const;
+    /**
+     * \return the size of the neighbor status update packets the periodic
+     * updates would have sent over the same time, in bytes
+     */
+    uint64_t GetNPeriodicStatusUpdateBytes(void) const;
+
+    /**
+     * \brief Sample the neighbor status, when run by the central sampler.
+     *
+     * Does what the sample period event of the router does when it samples
+     * on its own, see StatusSampler.
+     *
+     * \return false if the router is no longer sampled centrally, e.g. it
+     * has been disposed of, true otherwise
+     */
+    bool SampleNeighborStatus(void);
+
     /**
      * \brief Get the number of individual unicast routes that have been added
      * to the routing table.
@@ -276,11 +347,25 @@ class GBR : public Ipv4RoutingProtocol
      * \return Ipv4Route to route the packet to reach dest address
      */
     Ptr<Ipv4Route> LookupECMPRoute(Ipv4Address dest, Ptr<NetDevice> oif = 0);
+    /**
+     * \brief Lookup in the forwarding table for destination, with the DDR
+     * state of the packet.
+     *
+     * On success the distance of the selected route is stored in tag; the
+     * caller writes the tag back to the packet.
+     *
+     * \param dest destination address
+     * \param tag the DDR state of the packet
+     * \param idev input interface if any (routes on it are skipped)
+     * \return Ipv4Route to route the packet to reach dest address
+     */
     Ptr<Ipv4Route> LookupKShortRoute(Ipv4Address dest,
-                                     Ptr<Packet> p,
+                                     DdrTag& tag,
                                      Ptr<const NetDevice> idev = 0);
-    Ptr<Ipv4Route> LookupDGRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev = 0);
-    Ptr<Ipv4Route> LookupDDRRoute(Ipv4Address dest, Ptr<Packet> p, Ptr<const NetDevice> idev = 0);
+    /// \copydoc LookupKShortRoute
+    Ptr<Ipv4Route> LookupDGRRoute(Ipv4Address dest, DdrTag& tag, Ptr<const NetDevice> idev = 0);
+    /// \copydoc LookupKShortRoute
+    Ptr<Ipv4Route> LookupDDRRoute(Ipv4Address dest, DdrTag& tag, Ptr<const NetDevice> idev = 0);
 
     /**
      * Start protocol operation
@@ -325,6 +410,7 @@ class GBR : public Ipv4RoutingProtocol
     typedef std::list<RoutingTableEntry*>::iterator ASExternalRoutesI;
 
     HostRoutes m_hostRoutes;             //!< Routes to hosts
+    HostRouteIndex m_hostRouteIndex;     //!< Routes to hosts, indexed by destination
     NetworkRoutes m_networkRoutes;       //!< Routes to networks
     ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
     Ptr<Ipv4> m_ipv4;                    //!< associated IPv4 instance
@@ -348,8 +434,23 @@ class GBR : public Ipv4RoutingProtocol
 
     EventId m_nextUnsolicitedUpdate; //!< Next Unsolicited Update event
     EventId m_nextTriggeredUpdate;   //!< Next Triggered Update event
-
-    Time m_unsolicitedUpdate; //!< Time between two Unsolicited Neighbor State Updates.
+    bool m_centralSampling;          //!< sampled by the StatusSampler, not m_nextUnsolicitedUpdate
+
+    Time m_unsolicitedUpdate;          //!< Time between two Unsolicited Neighbor State Updates.
+    UpdateMode_t m_updateMode;         //!< periodic or triggered neighbor status updates
+    StateDelivery_t m_stateDelivery;   //!< packet or oracle delivery of the updates
+    uint8_t m_headerVersion;           //!< DgrHeader version of the updates sent
+    Time m_minTriggeredUpdateInterval; //!< Min time between two Triggered Updates.
+    Time m_fullUpdatePeriod;           //!< Time between two full updates, if triggered
+    Time m_lastTriggeredUpdate;        //!< time of the last Triggered Update
+    Time m_lastFullUpdate;             //!< time of the last full update
+    uint64_t m_nUpdatePackets;         //!< neighbor status update packets sent
+    uint64_t m_nUpdateBytes;           //!< neighbor status update bytes sent
+    uint64_t m_nPeriodicUpdatePackets; //!< update packets the periodic updates would send
+    uint64_t m_nPeriodicUpdateBytes;   //!< update bytes the periodic updates would send
+    uint32_t m_updateOverhead;         //!< bytes of an update packet but its NSEs
+    uint32_t m_updateNseSize;          //!< bytes of an NSE in an update packet
+    uint32_t m_nUpdateNses;            //!< NSEs of a periodic update
 
     // Time m_startupDelay;            //!< Random delay before protocol startup
     // Time m_minTriggeredUpdateDelay; //!< Min cooldown delay after a Triggered Update.
@@ -359,6 +460,78 @@ class GBR : public Ipv4RoutingProtocol
 
     std::set<uint32_t> m_interfaceExclusions; //!< Set of excluded interfaces
 
+    /**
+     * \brief A neighbor of an interface, as the oracle delivery reaches it.
+     */
+    struct OracleNeighbor
+    {
+        Ptr<GBR> m_gbr;       //!< routing protocol of the neighbor
+        uint32_t m_nodeId;    //!< node of the neighbor, the context of the deliveries
+        uint32_t m_interface; //!< interface of the neighbor on the link
+        Time m_delay;         //!< propagation delay of the link
+    };
+
+    /**
+     * \brief Per-interface state used on the forwarding path.
+     *
+     * Resolved once from the Ipv4 and TrafficControlLayer objects so that
+     * lookups do no object aggregation lookups or dynamic casts.
+     */
+    struct InterfaceCache
+    {
+        Ptr<NetDevice> m_device;                 //!< net device of the interface
+        Ptr<ValueDenseQueueDisc> m_qdisc;        //!< root queue disc of the device, if any
+        Ipv4Address m_local;                     //!< first local address of the interface
+        bool m_up;                               //!< true if the interface is up
+        bool m_loopback;                         //!< true if the device is a loopback device
+        int m_sentState;                         //!< state last sent in an update, -1 if none
+        uint32_t m_maxUpdateNses;                //!< NSEs that fit an update packet, by the MTU
+        std::vector<OracleNeighbor> m_neighbors; //!< neighbors on the link, oracle delivery only
+    };
+
+    std::vector<InterfaceCache> m_interfaceCache; //!< per-interface state, indexed by interface
+    bool m_interfaceCacheValid; //!< false if m_interfaceCache must be rebuilt before use
+
+    /**
+     * \brief Rebuild the per-interface cache from the Ipv4 object, and the
+     * prebuilt Ipv4Route of every routing table entry with it.
+     */
+    void UpdateInterfaceCache(void);
+
+    /**
+     * \brief Find the GBR neighbors on the link of an interface, for the
+     * oracle delivery of the neighbor states.
+     * \param cache the cache of the interface, its device already set
+     */
+    void UpdateOracleNeighbors(InterfaceCache& cache);
+
+    /**
+     * \brief Get the candidate host routes to a destination, asking the route
+     * manager to compute them if the routes are computed lazily.
+     * \param dest the destination address
+     * \return the candidates, or a null pointer if no route reaches dest
+     */
+    const HostRouteIndex::Candidates* LookupCandidates(Ipv4Address dest);
+
+    /**
+     * \brief Build the Ipv4Route handed out when a routing table entry is
+     * selected by a lookup.
+     * \param route the routing table entry
+     */
+    void BuildIpv4Route(RoutingTableEntry* route);
+
+    /**
+     * \brief Record the distance of the selected route in a packet.
+     *
+     * Packets carrying a DdrTag get it replaced; packets tagged by older
+     * applications get their DistTag replaced instead.
+     *
+     * \param p the packet
+     * \param tag the DDR state of the packet, with the new distance
+     * \param hasDdrTag true if the packet carries a DdrTag
+     */
+    void SetPacketDistance(Ptr<Packet> p, DdrTag& tag, bool hasDdrTag);
+
     /**
      * Receive an DGR message
      *
@@ -368,10 +541,62 @@ class GBR : public Ipv4RoutingProtocol
 
     /**
      * \brief Sending Neighbor Status Updates on all interfaces.
+     *
+     * A periodic update carries the state of every interface; a triggered
+     * update only the states that changed since they were last sent.
+     *
      * \param periodic true for periodic update, else triggered.
      */
     void DoSendNeighborStatusUpdate(bool periodic);
 
+    /**
+     * \brief Hand the NSEs of an update to the neighbors, oracle delivery.
+     *
+     * Every neighbor on the link of an interface that is up gets them after
+     * the propagation delay of the link, with no packet sent.
+     *
+     * \param nses the NSEs of the update
+     */
+    void DeliverNeighborStatusUpdate(const std::vector<DgrNse>& nses);
+
+    /**
+     * \brief Apply the NSEs of a neighbor, as delivered by the oracle.
+     *
+     * Does what Receive does for the packets of an update.
+     *
+     * \param incomingInterface the interface of the link to the neighbor
+     * \param nses the NSEs of the neighbor
+     */
+    void ReceiveNeighborStatusUpdate(uint32_t incomingInterface, std::vector<DgrNse> nses);
+
+    /**
+     * \brief Build the packets of a neighbor status update.
+     *
+     * The NSEs are split over as many packets as their DGR payload size
+     * requires.
+     *
+     * \param nses the NSEs of the update
+     * \param maxSize the maximum DGR payload size of a packet
+     * \param packets the packets, replaced by the packets built
+     */
+    void BuildStatusUpdatePackets(const std::vector<DgrNse>& nses,
+                                  uint32_t maxSize,
+                                  std::vector<Ptr<Packet>>& packets);
+
+    /**
+     * \return true if the state of an interface changed since it was last
+     * sent
+     */
+    bool HasStatusChanges(void);
+
+    /**
+     * \brief Account for the update a periodic update would send now, with
+     * triggered updates.
+     *
+     * Uses the packet sizes cached by UpdateInterfaceCache.
+     */
+    void CountPeriodicUpdate(void);
+
     // /**
     //  * \brief Send Neighbor Status Request on all interfaces
     // */
@@ -383,10 +608,21 @@ class GBR : public Ipv4RoutingProtocol
     void SendTriggeredNeighborStatusUpdate();
 
     /**
-     * \brief Send Unsolicited neighbor status information Updates on all interfaces.
+     * \brief Send Unsolicited neighbor status information Updates on all
+     * interfaces, and schedule the next sample.
      */
     void SendUnsolicitedUpdate();
 
+    /**
+     * \brief Sample the neighbor status and send the updates it calls for.
+     *
+     * Runs every sample period.  With triggered updates it sends a full
+     * update every FullUpdatePeriod, and in between schedules a triggered
+     * update when a state changed, at most one every
+     * MinTriggeredUpdateInterval.
+     */
+    void DoSampleNeighborStatus();
+
     // /**
     //  * \brief Handle DGR requests.
     //  *
@@ -402,18 +638,45 @@ class GBR : public Ipv4RoutingProtocol
     //                     uint32_t incomingInterface,
     //                     uint8_t hopLimit);
 
+    /**
+     * \brief Applies the NSEs of a DGR response to the NSDB while its header
+     * is parsed from the packet, without storing them.
+     */
+    class ResponseVisitor : public DgrHeader::NseVisitor
+    {
+      public:
+        /**
+         * \brief Constructor.
+         * \param gbr the routing protocol receiving the message
+         * \param incomingInterface incoming interface
+         */
+        ResponseVisitor(GBR* gbr, uint32_t incomingInterface);
+        bool VisitCommand(DgrHeader::Command_e command) override;
+        void VisitNse(uint32_t iface, uint32_t state) override;
+
+      private:
+        GBR* m_gbr;                   //!< routing protocol receiving the message
+        uint32_t m_incomingInterface; //!< incoming interface
+        NeighborStatusEntry* m_entry; //!< NSDB entry of the incoming interface
+    };
+
     /**
      * \brief Handle DGR responses.
      *
-     * \param hdr message header (including NSEs)
-     * \param senderAddress sender address
      * \param incomingInterface incoming interface
-     * \param hopLimit packet's hop limit
+     * \return the NSDB entry the NSEs of the response update, or a null
+     * pointer to ignore them
+     */
+    NeighborStatusEntry* HandleResponses(uint32_t incomingInterface);
+
+    /**
+     * \brief Handle one NSE of a DGR response.
+     *
+     * \param entry the NSDB entry of the incoming interface
+     * \param iface the interface of the neighbor
+     * \param state the state of the interface
      */
-    void HandleResponses(DgrHeader hdr,
-                         Ipv4Address senderAddress,
-                         uint32_t incomingInterface,
-                         uint8_t hopLimit);
+    void HandleNse(NeighborStatusEntry* entry, uint32_t iface, uint32_t state);
 
     // Ptr<OutputStreamWrapper> m_outStream = Create<OutputStreamWrapper>
     // ("queueStatusErr.txt", std::ios::out);
@@ -9,7 +9,11 @@ NS_LOG_COMPONENT_DEFINE ("NeighborStatusDatabase");
 
 StatusUnit::StatusUnit ()
   : m_matrix {0},
-    m_state (0)
+    m_state (0),
+    m_rowTotal {0},
+    m_rowWeighted {0},
+    m_estimateDDR (0),
+    m_lastUpdate (Time::Max ())
 {
 }
 
@@ -36,17 +40,11 @@ StatusUnit::GetEstimateState () const
 uint32_t
 StatusUnit::GetEstimateDelayDDR () const
 {
-  // std::cout << "current delay: " << GetEstimateDelayDGR () << std::endl;
-  // Print (std::cout);
-  uint32_t ret = 0;
-  int counter = 0;
-  for (int i = 0; i < STATESIZE; i ++)
-    {
-      ret += m_matrix[m_state][i]* (i);
-      counter += m_matrix[m_state][i];
-    }
-  return ret*2000/counter;
+  // Expected next state of the transition row of the last state, kept up to
+  // date by Update () since it is read for every candidate route.
+  return m_estimateDDR;
 }
+
 uint32_t
 StatusUnit::GetEstimateDelayDGR () const
 {
@@ -75,11 +73,39 @@ StatusUnit::GetLastState () const
   return m_state;
 }
 
+void
+StatusUnit::Update (int state, uint32_t nSamples)
+{
+  NS_ASSERT (nSamples > 0);
+  m_matrix[m_state][m_state] += nSamples - 1;
+  m_rowTotal[m_state] += nSamples - 1;
+  m_rowWeighted[m_state] += m_state * (nSamples - 1);
+  Update (state);
+}
+
+Time
+StatusUnit::GetLastUpdate () const
+{
+  return m_lastUpdate;
+}
+
 void
 StatusUnit::Update (int state)
 {
+  m_lastUpdate = Simulator::Now ();
   m_matrix[m_state][state] ++;
+  m_rowTotal[m_state] ++;
+  m_rowWeighted[m_state] += state;
   m_state = state;
+  if (m_rowTotal[m_state] == 0)
+    {
+      // no transition out of this state yet, expect it to last
+      m_estimateDDR = m_state * 2000;
+    }
+  else
+    {
+      m_estimateDDR = m_rowWeighted[m_state] * 2000 / m_rowTotal[m_state];
+    }
 }
 
 void
@@ -105,40 +131,31 @@ StatusUnit::Print (std::ostream &os) const
 //-- NeighborStatusEntry
 //------------------------------------------------------
 NeighborStatusEntry::NeighborStatusEntry ()
-    : m_database ()
+    : m_units ()
 {
 }
 
 NeighborStatusEntry::~NeighborStatusEntry ()
 {
-  m_database.clear ();
 }
 
-void
-NeighborStatusEntry::Insert (uint32_t n_iface, StatusUnit* su)
+StatusUnit*
+NeighborStatusEntry::HandleStatusUnit (uint32_t n_iface)
 {
-  NSMap_t::iterator it = m_database.find (n_iface);
-  if (it != m_database.end ())
-    {
-      it->second = su;
-    }
-  else
+  NS_LOG_FUNCTION (this << n_iface);
+  if (n_iface >= m_units.size ())
     {
-      m_database.insert (NSPair_t (n_iface, su));
+      m_units.resize (n_iface + 1);
     }
+  return &m_units[n_iface];
 }
 
-StatusUnit*
+const StatusUnit*
 NeighborStatusEntry::GetStatusUnit (uint32_t n_iface) const
 {
-  NS_LOG_FUNCTION (this << n_iface);
-  //
-  // Look up a SU by it's interface.
-  //
-  NSMap_t::const_iterator ci = m_database.find (n_iface);
-  if (ci != m_database.end ())
+  if (n_iface < m_units.size ())
     {
-      return ci->second;
+      return &m_units[n_iface];
     }
   return nullptr;
 }
@@ -147,18 +164,17 @@ NeighborStatusEntry::GetStatusUnit (uint32_t n_iface) const
 uint32_t
 NeighborStatusEntry::GetNumStatusUnit () const
 {
-  return m_database.size ();
+  return m_units.size ();
 }
 
 void
 NeighborStatusEntry::Print (std::ostream &os) const
 {
   os << "Next_Iface    StatusUnit" << std::endl;
-  NSMap_t::const_iterator ci;
-  for (ci = m_database.begin (); ci != m_database.end (); ci ++)
+  for (uint32_t i = 0; i < m_units.size (); i ++)
     {
-      os << ci->first << "    ";
-      ci->second->Print (os);
+      os << i << "    ";
+      m_units[i].Print (os);
     }
 }
 
@@ -176,14 +192,6 @@ DgrNSDB::DgrNSDB ()
 DgrNSDB::~DgrNSDB ()
 {
   NS_LOG_FUNCTION (this);
-  // NSDBMap_t::iterator i;
-  // for (i = m_database.begin (); i != m_database.end (); i ++)
-  //   {
-  //     NS_LOG_LOGIC ("Free NSE");
-  //     NeighborStatusEntry* temp = i->second;
-  //     delete temp;
-  //   }
-  NS_LOG_LOGIC ("Clear map");
   Initialize ();
 }
 
@@ -191,69 +199,48 @@ void
 DgrNSDB::Initialize ()
 {
   NS_LOG_FUNCTION (this);
-  m_database.clear ();
+  std::vector<NeighborStatusEntry> ().swap (m_database);
 }
 
-NeighborStatusEntry*
-DgrNSDB::GetNeighborStatusEntry (uint32_t iface) const
+void
+DgrNSDB::Initialize (uint32_t nInterfaces)
 {
-  NS_LOG_FUNCTION (this << iface);
-  //
-  // Look up a NSE by it's interface.
-  //
-  NSDBMap_t::const_iterator ci = m_database.find (iface);
-  if (ci != m_database.end ())
+  NS_LOG_FUNCTION (this << nInterfaces);
+  if (nInterfaces > m_database.size ())
     {
-      return ci->second;
+      m_database.resize (nInterfaces);
     }
-  return nullptr;
 }
 
-NeighborStatusEntry*
-DgrNSDB::HandleNeighborStatusEntry (uint32_t iface)
+const NeighborStatusEntry*
+DgrNSDB::GetNeighborStatusEntry (uint32_t iface) const
 {
-  NS_LOG_FUNCTION (this << iface);
-  //
-  // Look up a NSE by it's interface.
-  //
-  NSDBMap_t::iterator iter = m_database.find (iface);
-  if (iter != m_database.end ())
+  if (iface < m_database.size ())
     {
-      return iter->second;
+      return &m_database[iface];
     }
   return nullptr;
 }
 
-
-void
-DgrNSDB::Insert (uint32_t iface, NeighborStatusEntry* nse)
+NeighborStatusEntry*
+DgrNSDB::HandleNeighborStatusEntry (uint32_t iface)
 {
-  NS_LOG_FUNCTION (this << iface << nse);
-  NSDBMap_t::iterator it = m_database.find (iface);
-  if (it != m_database.end ())
-    {
-      std::cout << "Find a current nse" << std::endl;
-      it->second = nse;
-    }
-  else
+  NS_LOG_FUNCTION (this << iface);
+  if (iface >= m_database.size ())
     {
-      // std::cout << "not find, insert a new one";
-      m_database.insert (NSDBPair_t (iface, nse));
+      m_database.resize (iface + 1);
     }
+  return &m_database[iface];
 }
 
 void
 DgrNSDB::Print (std::ostream &os) const
 {
-  os << "At node: ???" << std::endl;
-  NSDBMap_t::const_iterator ci;
-  std::cout << "const iterator";
-  for (ci = m_database.begin (); ci != m_database.end (); ci ++)
+  for (uint32_t i = 0; i < m_database.size (); i ++)
     {
-      os << "Interface = " << ci->first << std::endl;
-      ci->second->Print (os);
+      os << "Interface = " << i << std::endl;
+      m_database[i].Print (os);
     }
-
 }
 
-}
\ No newline at end of file
+}
@@ -4,8 +4,7 @@
 
 #define STATESIZE 10
 #include "ns3/core-module.h"
-#include <map>
-#include <utility>
+#include <vector>
 namespace ns3 {
 
 
@@ -20,29 +19,61 @@ class StatusUnit
     uint32_t GetEstimateDelayDGR () const;  // in microsecond
     uint32_t GetEstimateDelayDDR () const;   // in microsecond
     void Update (int state);
+    /**
+     * \brief Record a state received after several sample periods without
+     * an update, as with triggered neighbor status updates.
+     *
+     * The last state is taken to have lasted the first nSamples - 1 periods.
+     *
+     * \param state the new state
+     * \param nSamples the sample periods since the last update, at least 1
+     */
+    void Update (int state, uint32_t nSamples);
+    /**
+     * \return the time of the last update, Time::Max () if none
+     */
+    Time GetLastUpdate () const;
     void Print (std::ostream &os) const;
   private:
     int m_matrix[STATESIZE][STATESIZE];
     int m_state; /** last state */
+    uint32_t m_rowTotal[STATESIZE]; /** transitions out of each state */
+    uint32_t m_rowWeighted[STATESIZE]; /** sum of the next states of each row */
+    uint32_t m_estimateDDR; /** GetEstimateDelayDDR () of the last state, updated by Update () */
+    Time m_lastUpdate; /** time of the last update */
 };
 
+/**
+ * \brief The status units of the neighbor on one interface, indexed by the
+ * interface of the neighbor they describe.
+ *
+ * The units are stored inline and created on the first state received for
+ * their interface; interfaces are small contiguous indices.
+ */
 class NeighborStatusEntry
 {
 public:
   NeighborStatusEntry ();
   ~NeighborStatusEntry ();
 
-  void Insert (uint32_t n_iface , StatusUnit* su);
-  StatusUnit* GetStatusUnit (uint32_t n_iface) const;
+  /**
+   * \brief Get the status unit of a neighbor interface, creating it if
+   * needed.
+   * \param n_iface the interface number of the neighbor
+   * \return the status unit, valid until the next unit is created
+   */
+  StatusUnit* HandleStatusUnit (uint32_t n_iface);
+  /**
+   * \param n_iface the interface number of the neighbor
+   * \return the status unit of the interface, or nullptr if no state was
+   * received for it or an interface with a higher number
+   */
+  const StatusUnit* GetStatusUnit (uint32_t n_iface) const;
   uint32_t GetNumStatusUnit () const;
   void Print (std::ostream &os) const;
   
 private:
-  typedef std::map<uint32_t, StatusUnit*>
-      NSMap_t; /** status, statistic*/
-  typedef std::pair<uint32_t, StatusUnit*> 
-      NSPair_t; //!< pair of <interface, StatusUnit>
-  NSMap_t m_database;
+  std::vector<StatusUnit> m_units; //!< status units, by neighbor interface
 };
 
 
@@ -78,32 +109,34 @@ class DgrNSDB : public Object
     */
     void Initialize ();
 
+    /**
+     * \brief Allocate the entries of the interfaces of the node.
+     *
+     * Called once the interfaces are known, so that receiving states does
+     * not allocate; the entries already allocated keep their units, and
+     * entries of interfaces added later are allocated on demand.
+     *
+     * \param nInterfaces the number of interfaces of the node
+    */
+    void Initialize (uint32_t nInterfaces);
+
     /**
      * \brief Get the NeighborStatusEntry of a Interface
      * 
      * \param iface The interface number
-     * \return NeighborStatusEntry*
+     * \return NeighborStatusEntry*, or nullptr if the interface is unknown
     */
-    NeighborStatusEntry* GetNeighborStatusEntry (uint32_t iface) const;
+    const NeighborStatusEntry* GetNeighborStatusEntry (uint32_t iface) const;
 
     /**
-     * \brief Handle the NeighborStatusEntry of a Interface
+     * \brief Handle the NeighborStatusEntry of a Interface, creating it if
+     * needed
      * 
      * \param iface The interface number
-     * \return NeighborStatusEntry*
+     * \return NeighborStatusEntry*, valid until the next entry is created
     */
     NeighborStatusEntry* HandleNeighborStatusEntry (uint32_t iface);
 
-    /**
-     * \brief Insert an <interface, Neighbor Status Entry> into the NSDB
-     *  
-     * The interface and NeighborStatusEntry given as parameters are converted
-     * to an STL pair and insert into the database map.
-     * \param iface interface number
-     * \param nse the neighbor status entry 
-    */
-    void Insert (uint32_t iface, NeighborStatusEntry* nse);
-    
     /**
      * \brief Print the database
      * 
@@ -111,15 +144,7 @@ class DgrNSDB : public Object
     void Print (std::ostream &os) const;
 
   private:
-    typedef std::map<uint32_t, NeighborStatusEntry*> 
-        NSDBMap_t;  //!< container of <interface, NeighborStatusEntry>
-    typedef std::pair<uint32_t, NeighborStatusEntry*> 
-        NSDBPair_t; //!< pair of <interface, NeighborStatusEntry>
-    typedef std::map<uint32_t, NeighborStatusEntry*>::iterator
-        NeighborStatusMapI; //!< NSE type iterator
-    typedef std::map<uint32_t, NeighborStatusEntry*>::const_iterator
-        NeighborStatusMapCI; //!< NSE type const iterator
-    NSDBMap_t m_database; //!< database of <interface, NeighborStatusEntry>
+    std::vector<NeighborStatusEntry> m_database; //!< neighbor status entries, by interface
 };
 
 }
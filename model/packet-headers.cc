@@ -2,6 +2,7 @@
 
 #include "packet-headers.h"
 
+#include "ns3/assert.h"
 #include "ns3/log.h"
 
 namespace ns3
@@ -9,6 +10,9 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("PacketHeaders");
 
+/// size of an NSE in the version 3 encoding: 8-bit interface, 8-bit state
+static const uint32_t DGR_COMPACT_NSE_SIZE = 2;
+
 //----------------------------------------------------------------------
 //-- DgrNse
 //------------------------------------------------------
@@ -100,7 +104,14 @@ operator<<(std::ostream& os, const DgrNse& h)
 NS_OBJECT_ENSURE_REGISTERED(DgrHeader);
 
 DgrHeader::DgrHeader()
-    : m_command(1)
+    : m_command(1),
+      m_version(3),
+      m_compact(true),
+      m_visitor(nullptr)
+{
+}
+
+DgrHeader::NseVisitor::~NseVisitor()
 {
 }
 
@@ -124,7 +135,7 @@ void
 DgrHeader::Print(std::ostream& os) const
 {
     os << "command " << int(m_command);
-    for (std::list<DgrNse>::const_iterator iter = m_nseList.begin(); iter != m_nseList.end();
+    for (std::vector<DgrNse>::const_iterator iter = m_nseList.begin(); iter != m_nseList.end();
          iter++)
     {
         os << " | ";
@@ -135,19 +146,31 @@ DgrHeader::Print(std::ostream& os) const
 uint32_t
 DgrHeader::GetSerializedSize() const
 {
-    DgrNse nse;
-    return 4 + m_nseList.size() * nse.GetSerializedSize();
+    return 4 + m_nseList.size() * GetNseSize();
 }
 
 void
 DgrHeader::Serialize(Buffer::Iterator start) const
 {
     Buffer::Iterator i = start;
+    uint8_t version = GetVersion();
     i.WriteU8(uint8_t(m_command)); // command : request and respond
-    i.WriteU8(2);                  // version 2
-    i.WriteU16(0);                 // blank
+    i.WriteU8(version);
+    if (version == 3)
+    {
+        i.WriteHtonU16(m_nseList.size());
+        for (std::vector<DgrNse>::const_iterator iter = m_nseList.begin();
+             iter != m_nseList.end();
+             iter++)
+        {
+            i.WriteU8(iter->GetInterface());
+            i.WriteU8(iter->GetState());
+        }
+        return;
+    }
+    i.WriteU16(0); // blank
 
-    for (std::list<DgrNse>::const_iterator iter = m_nseList.begin(); iter != m_nseList.end();
+    for (std::vector<DgrNse>::const_iterator iter = m_nseList.begin(); iter != m_nseList.end();
          iter++)
     {
         iter->Serialize(i);
@@ -171,29 +194,73 @@ DgrHeader::Deserialize(Buffer::Iterator start)
         return 0;
     }
 
-    if (i.ReadU8() != 2)
+    m_nseList.clear();
+    m_compact = true;
+    m_version = i.ReadU8();
+    uint16_t nseNumber = 0;
+    if (m_version == 3)
+    {
+        nseNumber = i.ReadNtohU16();
+        if (i.GetRemainingSize() < nseNumber * DGR_COMPACT_NSE_SIZE)
+        {
+            NS_LOG_LOGIC("DGR received a truncated message, ignoring.");
+            return 0;
+        }
+    }
+    else if (m_version == 2)
+    {
+        m_compact = false;
+        if (i.ReadU16() != 0)
+        {
+            NS_LOG_LOGIC("DGR received a message with invalid filled flags, ignoring.");
+            return 0;
+        }
+        // !!!!!!!!!!!!! the size should be the same with nse.
+        nseNumber = i.GetRemainingSize() / DgrNse().GetSerializedSize();
+    }
+    else
     {
         NS_LOG_LOGIC("DGR received a message with mismatch version, ignoring.");
         return 0;
     }
+    uint32_t size = 4 + nseNumber * GetNseSize();
 
-    if (i.ReadU16() != 0)
+    if (m_visitor && !m_visitor->VisitCommand(Command_e(m_command)))
     {
-        NS_LOG_LOGIC("DGR received a message with invalid filled flags, ignoring.");
-        return 0;
+        return size;
     }
-
-    DgrNse nse;
-    uint32_t nseSize = nse.GetSerializedSize();
-    uint8_t nseNumber =
-        i.GetRemainingSize() / nseSize; // !!!!!!!!!!!!! the size should be the same with nse.
-    for (uint8_t n = 0; n < nseNumber; n++)
+    if (!m_visitor)
+    {
+        m_nseList.reserve(nseNumber);
+    }
+    for (uint16_t n = 0; n < nseNumber; n++)
     {
-        i.Next(nse.Deserialize(i));
-        m_nseList.push_back(nse);
+        if (m_version == 3)
+        {
+            uint32_t iface = i.ReadU8();
+            AddParsedNse(iface, i.ReadU8());
+        }
+        else
+        {
+            uint32_t iface = i.ReadNtohU32();
+            AddParsedNse(iface, i.ReadNtohU32());
+        }
     }
+    return size;
+}
 
-    return GetSerializedSize();
+void
+DgrHeader::AddParsedNse(uint32_t iface, uint32_t state)
+{
+    if (m_visitor)
+    {
+        m_visitor->VisitNse(iface, state);
+        return;
+    }
+    DgrNse nse;
+    nse.SetInterface(iface);
+    nse.SetState(state);
+    m_nseList.push_back(nse);
 }
 
 void
@@ -211,6 +278,10 @@ DgrHeader::GetCommand() const
 void
 DgrHeader::AddNse(DgrNse nse)
 {
+    if (nse.GetInterface() > 0xff || nse.GetState() > 0xff)
+    {
+        m_compact = false;
+    }
     m_nseList.push_back(nse);
 }
 
@@ -218,6 +289,7 @@ void
 DgrHeader::ClearNses()
 {
     m_nseList.clear();
+    m_compact = true;
 }
 
 uint16_t
@@ -226,12 +298,41 @@ DgrHeader::GetNseNumber() const
     return m_nseList.size();
 }
 
-std::list<DgrNse>
+const std::vector<DgrNse>&
 DgrHeader::GetNseList() const
 {
     return m_nseList;
 }
 
+void
+DgrHeader::SetNseVisitor(NseVisitor* visitor)
+{
+    m_visitor = visitor;
+}
+
+void
+DgrHeader::SetVersion(uint8_t version)
+{
+    NS_ASSERT_MSG(version == 2 || version == 3, "Unknown DGR header version " << int(version));
+    m_version = version;
+}
+
+uint8_t
+DgrHeader::GetVersion() const
+{
+    return (m_version == 3 && m_compact) ? 3 : 2;
+}
+
+uint32_t
+DgrHeader::GetNseSize() const
+{
+    if (GetVersion() == 3)
+    {
+        return DGR_COMPACT_NSE_SIZE;
+    }
+    return DgrNse().GetSerializedSize();
+}
+
 std::ostream&
 operator<<(std::ostream& os, const DgrHeader& h)
 {
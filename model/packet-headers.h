@@ -7,13 +7,19 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/packet.h"
 
-#include <list>
+#include <vector>
 
 // ---Delay Guaranteed Routing Packet Header---
+// version 2:
 //   | 8 bite  | 8 bite  | 8 bite  | 8 bite  |
-//   | version | commond |       Empty       |
-//   | Interface ID      |      States       |
+//   | commond | version |       Empty       |
+//   |            Interface ID               |
+//   |               States                  |
 //                      ...
+// version 3 (compact):
+//   | 8 bite  | 8 bite  | 8 bite  | 8 bite  |
+//   | commond | version |   Number of NSEs  |
+//   | Iface   | State   | Iface   | State   |
 //                      ...
 
 namespace ns3
@@ -141,6 +147,30 @@ class DgrHeader : public Header
         RESPONSE = 0x2,
     };
 
+    /**
+     * \brief Receiver of the NSEs of a message, called while the message is
+     * deserialized instead of storing its NSEs in the header.
+     */
+    class NseVisitor
+    {
+      public:
+        virtual ~NseVisitor();
+
+        /**
+         * \brief Called once the command of the message is known.
+         * \param command the command
+         * \returns true to visit the NSEs of the message, false to skip them
+         */
+        virtual bool VisitCommand(Command_e command) = 0;
+
+        /**
+         * \brief Called for each NSE of the message, in order.
+         * \param iface the interface of the NSE
+         * \param state the state of the NSE
+         */
+        virtual void VisitNse(uint32_t iface, uint32_t state) = 0;
+    };
+
     /**
      * \brief Set the command
      * \param command the command
@@ -174,11 +204,57 @@ class DgrHeader : public Header
      * \brief Get the list of NSEs included in the message
      * \returns the list of DNEs in the message
      */
-    std::list<DgrNse> GetNseList() const;
+    const std::vector<DgrNse>& GetNseList() const;
+
+    /**
+     * \brief Hand the NSEs of the messages deserialized to a visitor.
+     *
+     * The NSEs are then read straight from the packet buffer and not stored
+     * in the header, so GetNseList () stays empty.
+     *
+     * \param visitor the visitor, or a null pointer to store the NSEs
+     */
+    void SetNseVisitor(NseVisitor* visitor);
+
+    /**
+     * \brief Set the encoding of the NSEs.
+     *
+     * Version 3 packs each NSE in two bytes, an 8-bit interface and an
+     * 8-bit state, and carries the number of NSEs in the header; version 2
+     * uses two 32-bit fields per NSE.  Receivers accept both.
+     *
+     * \param version 2 or 3 (the default)
+     */
+    void SetVersion(uint8_t version);
+
+    /**
+     * \brief Get the encoding of the NSEs.
+     *
+     * Version 3 falls back to version 2 when an NSE does not fit in it.
+     *
+     * \returns the version the message is serialized with
+     */
+    uint8_t GetVersion() const;
+
+    /**
+     * \brief Get the serialized size of one NSE in the message.
+     * \returns the size in GetVersion () encoding
+     */
+    uint32_t GetNseSize() const;
 
   private:
-    uint8_t m_command;           //!< command type
-    std::list<DgrNse> m_nseList; //!< list of the DNEs in the message
+    /**
+     * \brief Store or visit an NSE read by Deserialize ().
+     * \param iface the interface of the NSE
+     * \param state the state of the NSE
+     */
+    void AddParsedNse(uint32_t iface, uint32_t state);
+
+    uint8_t m_command;             //!< command type
+    uint8_t m_version;             //!< preferred encoding of the NSEs
+    bool m_compact;                //!< true if every NSE fits the version 3 encoding
+    std::vector<DgrNse> m_nseList; //!< list of the DNEs in the message
+    NseVisitor* m_visitor;         //!< receiver of the NSEs deserialized, if any
 };
 
 /**
@@ -429,4 +429,208 @@ NSTag::Print(std::ostream& os) const
     os << "ns = " << m_ns;
 }
 
+//----------------------------------------------------------------------
+//-- DdrTag
+//------------------------------------------------------
+NS_OBJECT_ENSURE_REGISTERED(DdrTag);
+
+DdrTag::DdrTag()
+    : m_deadline(0),
+      m_budget(0),
+      m_distance(UINT32_MAX - 1),
+      m_flags(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+DdrTag::SetTxTime(Time txTime)
+{
+    NS_LOG_FUNCTION(this << txTime);
+    m_deadline = static_cast<uint32_t>(txTime.GetMicroSeconds()) + m_budget;
+}
+
+Time
+DdrTag::GetTxTime(void) const
+{
+    NS_LOG_FUNCTION(this);
+    return MicroSeconds(Unwrap(m_deadline - m_budget));
+}
+
+void
+DdrTag::SetBudget(uint32_t budget)
+{
+    NS_LOG_FUNCTION(this << budget);
+    // keep the transmission time
+    m_deadline = m_deadline - m_budget + budget;
+    m_budget = budget;
+    m_flags |= FLAG_BUDGET;
+}
+
+uint32_t
+DdrTag::GetBudget(void) const
+{
+    NS_LOG_FUNCTION(this);
+    return m_budget;
+}
+
+bool
+DdrTag::HasBudget(void) const
+{
+    NS_LOG_FUNCTION(this);
+    return (m_flags & FLAG_BUDGET) != 0;
+}
+
+int64_t
+DdrTag::GetDeadline(void) const
+{
+    NS_LOG_FUNCTION(this);
+    return Unwrap(m_deadline);
+}
+
+int64_t
+DdrTag::Unwrap(uint32_t time)
+{
+    int64_t now = Simulator::Now().GetMicroSeconds();
+    // serial number arithmetic: the offset from now fits 31 bits
+    return now + static_cast<int32_t>(time - static_cast<uint32_t>(now));
+}
+
+void
+DdrTag::SetDistance(uint32_t distance)
+{
+    NS_LOG_FUNCTION(this << distance);
+    m_distance = distance;
+}
+
+uint32_t
+DdrTag::GetDistance(void) const
+{
+    NS_LOG_FUNCTION(this);
+    return m_distance;
+}
+
+void
+DdrTag::SetPriority(bool priority)
+{
+    NS_LOG_FUNCTION(this << priority);
+    if (priority)
+    {
+        m_flags |= FLAG_PRIORITY;
+    }
+    else
+    {
+        m_flags &= ~FLAG_PRIORITY;
+    }
+}
+
+bool
+DdrTag::GetPriority(void) const
+{
+    NS_LOG_FUNCTION(this);
+    return (m_flags & FLAG_PRIORITY) != 0;
+}
+
+void
+DdrTag::SetMeasure(bool measure)
+{
+    NS_LOG_FUNCTION(this << measure);
+    if (measure)
+    {
+        m_flags |= FLAG_MEASURE;
+    }
+    else
+    {
+        m_flags &= ~FLAG_MEASURE;
+    }
+}
+
+bool
+DdrTag::GetMeasure(void) const
+{
+    NS_LOG_FUNCTION(this);
+    return (m_flags & FLAG_MEASURE) != 0;
+}
+
+bool
+DdrTag::PeekLegacyTags(Ptr<const Packet> p)
+{
+    NS_LOG_FUNCTION(this << p);
+    BudgetTag budgetTag;
+    if (!p->PeekPacketTag(budgetTag))
+    {
+        return false;
+    }
+    SetBudget(budgetTag.GetBudget());
+
+    TimestampTag timestampTag;
+    if (p->PeekPacketTag(timestampTag))
+    {
+        SetTxTime(timestampTag.GetTimestamp());
+    }
+    DistTag distTag;
+    if (p->PeekPacketTag(distTag))
+    {
+        SetDistance(distTag.GetDistance());
+    }
+    FlagTag flagTag;
+    if (p->PeekPacketTag(flagTag))
+    {
+        SetMeasure(flagTag.GetFlag());
+    }
+    // the queue disc classifies on the presence of the tag, not its value
+    PriorityTag priorityTag;
+    SetPriority(p->PeekPacketTag(priorityTag));
+    return true;
+}
+
+TypeId
+DdrTag::GetTypeId(void)
+{
+    static TypeId tid =
+        TypeId("ns3::DdrTag").SetParent<Tag>().SetGroupName("dgr-rl").AddConstructor<DdrTag>();
+    return tid;
+}
+
+TypeId
+DdrTag::GetInstanceTypeId(void) const
+{
+    return GetTypeId();
+}
+
+uint32_t
+DdrTag::GetSerializedSize(void) const
+{
+    NS_LOG_FUNCTION(this);
+    return 13; // 4 + 4 + 4 + 1 bytes
+}
+
+void
+DdrTag::Serialize(TagBuffer i) const
+{
+    NS_LOG_FUNCTION(this << &i);
+    i.WriteU32(m_deadline);
+    i.WriteU32(m_budget);
+    i.WriteU32(m_distance);
+    i.WriteU8(m_flags);
+}
+
+void
+DdrTag::Deserialize(TagBuffer i)
+{
+    NS_LOG_FUNCTION(this << &i);
+    m_deadline = i.ReadU32();
+    m_budget = i.ReadU32();
+    m_distance = i.ReadU32();
+    m_flags = i.ReadU8();
+}
+
+void
+DdrTag::Print(std::ostream& os) const
+{
+    NS_LOG_FUNCTION(this << &os);
+    os << "deadline=" << m_deadline << "us budget=" << m_budget << " distance=" << m_distance
+       << " flags=" << static_cast<uint32_t>(m_flags);
+}
+
 } // namespace ns3
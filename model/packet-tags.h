@@ -278,6 +278,156 @@ class NSTag : public Tag
     bool m_ns;
 };
 
+/**
+ * \brief This class implements a single tag that carries all the per-packet
+ * state used by delay-driven routing: the absolute deadline, the delay
+ * budget, the distance to the destination of the last route taken, and the
+ * priority and measurement flags.
+ *
+ * It replaces the combination of BudgetTag, TimestampTag, DistTag, FlagTag
+ * and PriorityTag, so that a router peeks and replaces one tag per hop.
+ * Packets that still carry the separate tags are understood through
+ * PeekLegacyTags.
+ *
+ * The deadline is kept in microseconds, modulo 2^32, and is unwrapped
+ * against the current simulation time, so a packet must be delivered
+ * within about 35 minutes of its deadline.  The transmission time is the
+ * deadline minus the budget, at microsecond resolution; a packet without a
+ * budget has its transmission time as deadline.
+ */
+class DdrTag : public Tag
+{
+  public:
+    DdrTag();
+
+    /**
+     * \brief Set the transmission time of the packet
+     * \param txTime the transmission time
+     */
+    void SetTxTime(Time txTime);
+
+    /**
+     * \brief Get the transmission time of the packet
+     * \return the transmission time
+     */
+    Time GetTxTime(void) const;
+
+    /**
+     * \brief Set the delay budget of the packet
+     * \param budget the delay budget in microsecond
+     */
+    void SetBudget(uint32_t budget);
+
+    /**
+     * \brief Get the delay budget of the packet
+     * \return the delay budget in microsecond
+     */
+    uint32_t GetBudget(void) const;
+
+    /**
+     * \return true if the packet has a delay budget
+     */
+    bool HasBudget(void) const;
+
+    /**
+     * \brief Get the absolute deadline of the packet, i.e., its transmission
+     * time plus its delay budget
+     * \return the deadline in microsecond
+     */
+    int64_t GetDeadline(void) const;
+
+    /**
+     * \brief Set the distance to the destination of the last route taken
+     * \param distance the distance
+     */
+    void SetDistance(uint32_t distance);
+
+    /**
+     * \brief Get the distance to the destination of the last route taken
+     * \return the distance, UINT32_MAX - 1 if no route was taken yet
+     */
+    uint32_t GetDistance(void) const;
+
+    /**
+     * \brief Set the priority of the packet
+     * \param priority true for delay sensitive packets
+     */
+    void SetPriority(bool priority);
+
+    /**
+     * \brief Get the priority of the packet
+     * \return true for delay sensitive packets
+     */
+    bool GetPriority(void) const;
+
+    /**
+     * \brief Set the measurement flag of the packet
+     * \param measure true if the sink records the delay of the packet
+     */
+    void SetMeasure(bool measure);
+
+    /**
+     * \brief Get the measurement flag of the packet
+     * \return true if the sink records the delay of the packet
+     */
+    bool GetMeasure(void) const;
+
+    /**
+     * \brief Fill this tag from the separate tags of a packet.
+     *
+     * Compatibility path for packets tagged with BudgetTag, TimestampTag,
+     * DistTag, FlagTag and PriorityTag.  The other tags are only read when
+     * the packet carries a BudgetTag.
+     *
+     * \param p the packet
+     * \return true if the packet carries a BudgetTag
+     */
+    bool PeekLegacyTags(Ptr<const Packet> p);
+
+    /**
+     * \brief Get the Type ID
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId(void);
+
+    // inherited function, no need to doc.
+    TypeId GetInstanceTypeId(void) const override;
+
+    // inherited function, no need to doc.
+    uint32_t GetSerializedSize(void) const override;
+
+    // inherited function, no need to doc.
+    void Serialize(TagBuffer i) const override;
+
+    // inherited function, no need to doc.
+    void Deserialize(TagBuffer i) override;
+
+    // inherited function, no need to doc.
+    void Print(std::ostream& os) const override;
+
+  private:
+    /// flags carried by the tag
+    enum Flag_e
+    {
+        FLAG_BUDGET = 0x1,   //!< the packet has a delay budget
+        FLAG_PRIORITY = 0x2, //!< the packet is delay sensitive
+        FLAG_MEASURE = 0x4   //!< the sink records the delay of the packet
+    };
+
+    /**
+     * \brief Get the absolute time of a microsecond timestamp of the tag
+     * \param time the timestamp, modulo 2^32
+     * \return the timestamp closest to the current simulation time, in
+     * microsecond
+     */
+    static int64_t Unwrap(uint32_t time);
+
+    uint32_t m_deadline; //!< deadline in microsecond, modulo 2^32
+    uint32_t m_budget;   //!< delay budget in microsecond
+    uint32_t m_distance; //!< distance of the last route taken
+    uint8_t m_flags;     //!< Flag_e bits
+};
+
 } // namespace ns3
 
 #endif /* PACKET_TAGS_H */
\ No newline at end of file
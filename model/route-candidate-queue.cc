@@ -59,22 +59,27 @@ operator<<(std::ostream& os, const Vertex::VertexType& t)
 std::ostream&
 operator<<(std::ostream& os, const RouteCandidateQueue& q)
 {
-    typedef RouteCandidateQueue::DGRCandidateList_t List_t;
-    typedef List_t::const_iterator CIter_t;
-    const RouteCandidateQueue::DGRCandidateList_t& list = q.m_candidates;
+    typedef RouteCandidateQueue::DGRCandidateHeap_t Heap_t;
+    typedef Heap_t::const_iterator CIter_t;
+    // print the candidates in the order they would be popped
+    Heap_t sorted = q.m_candidates;
+    std::sort(sorted.begin(), sorted.end(), &RouteCandidateQueue::CompareCandidate);
 
     os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
-    for (CIter_t iter = list.begin(); iter != list.end(); iter++)
+    for (CIter_t iter = sorted.begin(); iter != sorted.end(); iter++)
     {
-        os << "<" << (*iter)->GetVertexId() << ", " << (*iter)->GetDistanceFromRoot() << ", "
-           << (*iter)->GetVertexType() << ">" << std::endl;
+        const Vertex* v = iter->m_vertex;
+        os << "<" << v->GetVertexId() << ", " << v->GetDistanceFromRoot() << ", "
+           << v->GetVertexType() << ">" << std::endl;
     }
     os << "*** CandidateQueue End ***";
     return os;
 }
 
 RouteCandidateQueue::RouteCandidateQueue()
-    : m_candidates()
+    : m_candidates(),
+      m_positions(),
+      m_order(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -89,12 +94,9 @@ void
 RouteCandidateQueue::Clear(void)
 {
     NS_LOG_FUNCTION(this);
-    while (!m_candidates.empty())
-    {
-        Vertex* p = Pop();
-        delete p;
-        p = 0;
-    }
+    m_candidates.clear();
+    m_positions.clear();
+    m_order = 0;
 }
 
 void
@@ -102,11 +104,13 @@ RouteCandidateQueue::Push(Vertex* vNew)
 {
     NS_LOG_FUNCTION(this << vNew);
 
-    DGRCandidateList_t::iterator i = std::upper_bound(m_candidates.begin(),
-                                                      m_candidates.end(),
-                                                      vNew,
-                                                      &RouteCandidateQueue::CompareVertex);
-    m_candidates.insert(i, vNew);
+    Candidate c;
+    c.m_vertex = vNew;
+    c.m_order = m_order++;
+    m_candidates.push_back(c);
+    uint32_t i = m_candidates.size() - 1;
+    m_positions[vNew->GetVertexId()] = i;
+    SiftUp(i);
 }
 
 Vertex*
@@ -118,8 +122,15 @@ RouteCandidateQueue::Pop(void)
         return 0;
     }
 
-    Vertex* v = m_candidates.front();
-    m_candidates.pop_front();
+    Vertex* v = m_candidates.front().m_vertex;
+    m_positions.erase(v->GetVertexId());
+    Candidate last = m_candidates.back();
+    m_candidates.pop_back();
+    if (!m_candidates.empty())
+    {
+        Place(0, last);
+        SiftDown(0);
+    }
     return v;
 }
 
@@ -132,7 +143,7 @@ RouteCandidateQueue::Top(void) const
         return 0;
     }
 
-    return m_candidates.front();
+    return m_candidates.front().m_vertex;
 }
 
 bool
@@ -153,18 +164,28 @@ Vertex*
 RouteCandidateQueue::Find(const Ipv4Address addr) const
 {
     NS_LOG_FUNCTION(this);
-    DGRCandidateList_t::const_iterator i = m_candidates.begin();
-
-    for (; i != m_candidates.end(); i++)
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator i =
+        m_positions.find(addr);
+    if (i == m_positions.end())
     {
-        Vertex* v = *i;
-        if (v->GetVertexId() == addr)
-        {
-            return v;
-        }
+        return 0;
     }
+    return m_candidates[i->second].m_vertex;
+}
 
-    return 0;
+void
+RouteCandidateQueue::DecreaseKey(Vertex* v)
+{
+    NS_LOG_FUNCTION(this << v);
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator i =
+        m_positions.find(v->GetVertexId());
+    NS_ASSERT_MSG(i != m_positions.end(), "Vertex " << v->GetVertexId() << " is not queued");
+    uint32_t pos = i->second;
+    NS_ASSERT(m_candidates[pos].m_vertex == v);
+    // A vertex whose distance dropped ranks after the vertices already queued
+    // at its new distance, as if it had just been pushed.
+    m_candidates[pos].m_order = m_order++;
+    SiftUp(pos);
 }
 
 void
@@ -172,11 +193,78 @@ RouteCandidateQueue::Reorder(void)
 {
     NS_LOG_FUNCTION(this);
 
-    m_candidates.sort(&RouteCandidateQueue::CompareVertex);
+    for (uint32_t i = m_candidates.size() / 2; i > 0; i--)
+    {
+        SiftDown(i - 1);
+    }
     NS_LOG_LOGIC("After reordering the CandidateQueue");
     NS_LOG_LOGIC(*this);
 }
 
+void
+RouteCandidateQueue::Place(uint32_t i, const Candidate& c)
+{
+    m_candidates[i] = c;
+    m_positions[c.m_vertex->GetVertexId()] = i;
+}
+
+void
+RouteCandidateQueue::SiftUp(uint32_t i)
+{
+    Candidate c = m_candidates[i];
+    while (i > 0)
+    {
+        uint32_t parent = (i - 1) / 2;
+        if (!CompareCandidate(c, m_candidates[parent]))
+        {
+            break;
+        }
+        Place(i, m_candidates[parent]);
+        i = parent;
+    }
+    Place(i, c);
+}
+
+void
+RouteCandidateQueue::SiftDown(uint32_t i)
+{
+    uint32_t n = m_candidates.size();
+    Candidate c = m_candidates[i];
+    while (true)
+    {
+        uint32_t child = 2 * i + 1;
+        if (child >= n)
+        {
+            break;
+        }
+        if (child + 1 < n && CompareCandidate(m_candidates[child + 1], m_candidates[child]))
+        {
+            child++;
+        }
+        if (!CompareCandidate(m_candidates[child], c))
+        {
+            break;
+        }
+        Place(i, m_candidates[child]);
+        i = child;
+    }
+    Place(i, c);
+}
+
+bool
+RouteCandidateQueue::CompareCandidate(const Candidate& c1, const Candidate& c2)
+{
+    if (CompareVertex(c1.m_vertex, c2.m_vertex))
+    {
+        return true;
+    }
+    if (CompareVertex(c2.m_vertex, c1.m_vertex))
+    {
+        return false;
+    }
+    return c1.m_order < c2.m_order;
+}
+
 /*
  * In this implementation, Vertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -23,8 +23,9 @@
 
 #include "ns3/ipv4-address.h"
 
-#include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -46,9 +47,14 @@ class Vertex;
  * priority queue.
  *
  * Although a STL priority_queue almost does what we want, the requirement
- * for a Find () operation, the dynamic nature of the data and the derived
- * requirement for a Reorder () operation led us to implement this simple
- * enhanced priority queue.
+ * for a Find () operation and for lowering the distance of a queued vertex
+ * led us to implement this indexed binary heap.  Push, Pop and DecreaseKey
+ * are O(log n); Find is O(1) through a hash index from vertex ID to heap
+ * position.
+ *
+ * Vertices at the same distance are popped networks first, then in the
+ * order they were pushed (or last had their distance lowered), which is the
+ * order the former sorted-list implementation produced.
  */
 class RouteCandidateQueue
 {
@@ -61,16 +67,18 @@ class RouteCandidateQueue
     RouteCandidateQueue();
 
     /**
-     * @brief Destroy an SPF Candidate Queue and release any resources held
-     * by the contents.
+     * @brief Destroy an SPF Candidate Queue.
+     *
+     * The vertices are owned by the VertexArena of the SPF calculation and
+     * are not deleted.
      *
      * @see Vertex
      */
     virtual ~RouteCandidateQueue();
 
     /**
-     * @brief Empty the Candidate Queue and release all of the resources
-     * associated with the Shortest Path First Vertex pointers in the queue.
+     * @brief Empty the Candidate Queue, keeping its storage for the next
+     * SPF calculation.
      *
      * @see Vertex
      */
@@ -93,8 +101,7 @@ class RouteCandidateQueue
     /**
      * @brief Pop the Shortest Path First Vertex pointer at the top of the queue.
      *
-     * The caller is given the responsibility for releasing the resources
-     * associated with the vertex.
+     * The vertex remains owned by the VertexArena it was allocated from.
      *
      * @see Vertex
      * @see Top ()
@@ -141,6 +148,16 @@ class RouteCandidateQueue
      */
     Vertex* Find(const Ipv4Address addr) const;
 
+    /**
+     * @brief Restore the priority order after the distance of a queued vertex
+     * has been lowered.
+     *
+     * @see Vertex
+     * @param v The Shortest Path First Vertex whose m_distanceFromRoot
+     * decreased; it must be in the queue.
+     */
+    void DecreaseKey(Vertex* v);
+
     /**
      * @brief Reorders the Candidate Queue according to the priority scheme.
      *
@@ -150,7 +167,8 @@ class RouteCandidateQueue
      * increasing distance.
      *
      * This method is provided in case the values of m_distanceFromRoot change
-     * during the routing calculations.
+     * during the routing calculations.  When only one vertex changed, prefer
+     * DecreaseKey ().
      *
      * @see Vertex
      */
@@ -186,8 +204,47 @@ class RouteCandidateQueue
      */
     static bool CompareVertex(const Vertex* v1, const Vertex* v2);
 
-    typedef std::list<Vertex*> DGRCandidateList_t; //!< container of Vertex pointers
-    DGRCandidateList_t m_candidates;               //!< Vertex candidates
+    /**
+     * \brief An element of the heap.
+     */
+    struct Candidate
+    {
+        Vertex* m_vertex; //!< the vertex
+        uint32_t m_order; //!< push order, breaks the ties left by CompareVertex
+    };
+
+    /**
+     * \brief return true if c1 must be popped before c2
+     * \param c1 first operand
+     * \param c2 second operand
+     * \return True if c1 should be popped before c2; false otherwise
+     */
+    static bool CompareCandidate(const Candidate& c1, const Candidate& c2);
+
+    /**
+     * \brief Move an element up the heap until its parent precedes it.
+     * \param i heap position of the element
+     */
+    void SiftUp(uint32_t i);
+
+    /**
+     * \brief Move an element down the heap until it precedes its children.
+     * \param i heap position of the element
+     */
+    void SiftDown(uint32_t i);
+
+    /**
+     * \brief Put an element at a heap position and record it in the index.
+     * \param i heap position
+     * \param c the element
+     */
+    void Place(uint32_t i, const Candidate& c);
+
+    typedef std::vector<Candidate> DGRCandidateHeap_t; //!< binary heap of candidates
+    DGRCandidateHeap_t m_candidates;                   //!< Vertex candidates
+    /// heap position of every candidate, by vertex ID
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_positions;
+    uint32_t m_order; //!< order given to the next pushed vertex
 
     /**
      * \brief Stream insertion operator.
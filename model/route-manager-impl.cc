@@ -29,18 +29,27 @@
 #include "router-interface.h"
 
 #include "ns3/assert.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
 #include "ns3/fatal-error.h"
+#include "ns3/global-value.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4.h"
 #include "ns3/log.h"
 #include "ns3/node-list.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
 #include <algorithm>
 #include <chrono>
 #include <ctime>
+#include <fstream>
+#include <functional>
 #include <iostream>
 #include <queue>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -49,6 +58,120 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("RouteManagerImpl");
 
+/**
+ * \brief Number of threads computing the routing tables.
+ *
+ * 1 runs the SPF calculations on the simulation thread, 0 uses one thread
+ * per hardware thread.  The routes do not depend on this value.
+ */
+static GlobalValue g_spfThreads("GBRSpfThreads",
+                                "Number of threads used to compute the GBR routing tables "
+                                "(0 = one per hardware thread)",
+                                UintegerValue(1),
+                                MakeUintegerChecker<uint32_t>());
+
+/**
+ * \brief Hold-down window of the route updates triggered by interface events.
+ *
+ * The events of a window are coalesced into a single route update, run at
+ * its end.  With a zero window, the events of a simulation instant are.
+ */
+static GlobalValue g_routeHoldDown("GBRRouteHoldDown",
+                                   "Time the GBR route update triggered by an interface event "
+                                   "waits for further events",
+                                   TimeValue(Seconds(0)),
+                                   MakeTimeChecker());
+
+/**
+ * \brief Algorithm computing the routing tables.
+ */
+static GlobalValue g_routeEngine("GBRRouteEngine",
+                                 "Algorithm used to compute the GBR routing tables",
+                                 EnumValue(RouteManagerImpl::SPF_ENGINE),
+                                 MakeEnumChecker(RouteManagerImpl::SPF_ENGINE,
+                                                 "Spf",
+                                                 RouteManagerImpl::REVERSE_SPF_ENGINE,
+                                                 "ReverseSpf"));
+
+/**
+ * \brief Whether the routes to a destination router are only computed when a
+ * router first looks one up.
+ */
+static GlobalValue g_lazyRoutes("GBRLazyRoutes",
+                                "Compute the GBR routes to a destination router the first time "
+                                "one is looked up instead of when the tables are built",
+                                BooleanValue(false),
+                                MakeBooleanChecker());
+
+/**
+ * \brief Whether the routing tables hold one host route per destination
+ * router and output interface instead of one per destination address.
+ */
+static GlobalValue g_compressedTables("GBRCompressedTables",
+                                      "Install one GBR host route per destination router and "
+                                      "output interface, shared by all the addresses of the router",
+                                      BooleanValue(false),
+                                      MakeBooleanChecker());
+
+/// magic number of the routing table snapshots, "GBRT" in little-endian order
+static const uint32_t SNAPSHOT_MAGIC = 0x54524247;
+/// version of the snapshot format, bumped on any change of the layout
+static const uint32_t SNAPSHOT_VERSION = 1;
+/// size of a snapshot header: magic, version, topology hash, number of routes
+static const uint32_t SNAPSHOT_HEADER_SIZE = 20;
+/// size of a snapshot route record: eight 32-bit fields
+static const uint32_t SNAPSHOT_RECORD_SIZE = 32;
+
+/**
+ * \brief Append a 32-bit value to a snapshot, in little-endian order.
+ *
+ * \param buffer the snapshot
+ * \param value the value
+ */
+static void
+WriteSnapshotUint32(std::string& buffer, uint32_t value)
+{
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+/**
+ * \brief Read a little-endian 32-bit value of a snapshot.
+ *
+ * \param data the first byte of the value
+ * \returns the value
+ */
+static uint32_t
+ReadSnapshotUint32(const char* data)
+{
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * \brief Add a 32-bit value to a 64-bit FNV-1a hash, byte by byte.
+ *
+ * \param hash the hash
+ * \param value the value
+ * \returns the new hash
+ */
+static uint64_t
+HashUint32(uint64_t hash, uint32_t value)
+{
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        hash ^= (value >> (8 * i)) & 0xff;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 /**
  * \brief Stream insertion operator.
  *
@@ -131,53 +254,31 @@ Vertex::Vertex(LSA* lsa)
 Vertex::~Vertex()
 {
     NS_LOG_FUNCTION(this);
+}
 
-    NS_LOG_LOGIC("Children vertices - " << m_children);
-    NS_LOG_LOGIC("Parent verteices - " << m_parents);
+void
+Vertex::Reset(LSA* lsa)
+{
+    NS_LOG_FUNCTION(this << lsa);
+    m_vertexType = VertexUnknown;
+    m_vertexId = lsa->GetLinkStateId();
+    m_lsa = lsa;
+    m_distanceFromRoot = DISTINFINITY;
+    m_rootOif = DISTINFINITY;
+    m_nextHop = Ipv4Address("0.0.0.0");
+    m_ecmpRootExits.clear();
+    m_parents.clear();
+    m_children.clear();
+    m_vertexProcessed = false;
 
-    // find this node from all its parents and remove the entry of this node
-    // from all its parents
-    for (ListOfVertex_t::iterator piter = m_parents.begin(); piter != m_parents.end(); piter++)
+    if (lsa->GetLSType() == LSA::RouterLSA)
     {
-        // remove the current vertex from its parent's children list. Check
-        // if the size of the list is reduced, or the child<->parent relation
-        // is not bidirectional
-        uint32_t orgCount = (*piter)->m_children.size();
-        (*piter)->m_children.remove(this);
-        uint32_t newCount = (*piter)->m_children.size();
-        if (orgCount > newCount)
-        {
-            NS_ASSERT_MSG(orgCount > newCount,
-                          "Unable to find the current vertex from its parents --- impossible!");
-        }
+        m_vertexType = Vertex::VertexRouter;
     }
-
-    // delete children
-    while (m_children.size() > 0)
+    else if (lsa->GetLSType() == LSA::NetworkLSA)
     {
-        // pop out children one by one. Some children may disappear
-        // when deleting some other children in the list. As a result,
-        // it is necessary to use pop to walk through all children, instead
-        // of using iterator.
-        //
-        // Note that m_children.pop_front () is not necessary as this
-        // p is removed from the children list when p is deleted
-        Vertex* p = m_children.front();
-        // 'p' == 0, this child is already deleted by its other parent
-        if (p == 0)
-            continue;
-        NS_LOG_LOGIC("Parent vertex-" << m_vertexId << " deleting its child vertex-"
-                                      << p->GetVertexId());
-        delete p;
-        p = 0;
+        m_vertexType = Vertex::VertexNetwork;
     }
-    m_children.clear();
-    // delete parents
-    m_parents.clear();
-    // delete root exit direction
-    m_ecmpRootExits.clear();
-
-    NS_LOG_LOGIC("Vertex-" << m_vertexId << " completed deleted");
 }
 
 void
@@ -257,12 +358,7 @@ Vertex::GetParent(uint32_t i) const
         NS_LOG_LOGIC("Index to Vertex's parent is out-of-range.");
         return 0;
     }
-    ListOfVertex_t::const_iterator iter = m_parents.begin();
-    while (i-- > 0)
-    {
-        iter++;
-    }
-    return *iter;
+    return m_parents[i];
 }
 
 void
@@ -274,8 +370,8 @@ Vertex::MergeParent(const Vertex* v)
     // combine the two lists first, and then remove any duplicated after
     m_parents.insert(m_parents.end(), v->m_parents.begin(), v->m_parents.end());
     // remove duplication
-    m_parents.sort();
-    m_parents.unique();
+    std::sort(m_parents.begin(), m_parents.end());
+    m_parents.erase(std::unique(m_parents.begin(), m_parents.end()), m_parents.end());
     NS_LOG_LOGIC("After merge, list of parents = " << m_parents);
 }
 
@@ -304,17 +400,10 @@ Vertex::NodeExit_t
 Vertex::GetRootExitDirection(uint32_t i) const
 {
     NS_LOG_FUNCTION(this << i);
-    typedef ListOfNodeExit_t::const_iterator CIter_t;
 
     NS_ASSERT_MSG(i < m_ecmpRootExits.size(),
                   "Index out-of-range when accessing Vertex::m_ecmpRootExits!");
-    CIter_t iter = m_ecmpRootExits.begin();
-    while (i-- > 0)
-    {
-        iter++;
-    }
-
-    return *iter;
+    return m_ecmpRootExits[i];
 }
 
 Vertex::NodeExit_t
@@ -337,8 +426,9 @@ Vertex::MergeRootExitDirections(const Vertex* vertex)
     // Append the external list into 'this' and remove duplication afterward
     const ListOfNodeExit_t& extList = vertex->m_ecmpRootExits;
     m_ecmpRootExits.insert(m_ecmpRootExits.end(), extList.begin(), extList.end());
-    m_ecmpRootExits.sort();
-    m_ecmpRootExits.unique();
+    std::sort(m_ecmpRootExits.begin(), m_ecmpRootExits.end());
+    m_ecmpRootExits.erase(std::unique(m_ecmpRootExits.begin(), m_ecmpRootExits.end()),
+                          m_ecmpRootExits.end());
 }
 
 void
@@ -376,17 +466,8 @@ Vertex*
 Vertex::GetChild(uint32_t n) const
 {
     NS_LOG_FUNCTION(this << n);
-    uint32_t j = 0;
-
-    for (ListOfVertex_t::const_iterator i = m_children.begin(); i != m_children.end(); i++, j++)
-    {
-        if (j == n)
-        {
-            return *i;
-        }
-    }
-    NS_ASSERT_MSG(false, "Index <n> out of range.");
-    return 0;
+    NS_ASSERT_MSG(n < m_children.size(), "Index <n> out of range.");
+    return m_children[n];
 }
 
 uint32_t
@@ -422,6 +503,55 @@ Vertex::ClearVertexProcessed(void)
     this->SetVertexProcessed(false);
 }
 
+// ---------------------------------------------------------------------------
+//
+// VertexArena Implementation
+//
+// ---------------------------------------------------------------------------
+
+/// number of vertices in a chunk of a VertexArena
+static const uint32_t VERTEX_ARENA_CHUNK = 256;
+
+VertexArena::VertexArena()
+    : m_chunks(),
+      m_next(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+VertexArena::~VertexArena()
+{
+    NS_LOG_FUNCTION(this);
+    for (std::vector<Vertex*>::iterator i = m_chunks.begin(); i != m_chunks.end(); i++)
+    {
+        delete[] *i;
+    }
+    m_chunks.clear();
+}
+
+Vertex*
+VertexArena::Allocate(LSA* lsa)
+{
+    NS_LOG_FUNCTION(this << lsa);
+    uint32_t chunk = m_next / VERTEX_ARENA_CHUNK;
+    if (chunk == m_chunks.size())
+    {
+        NS_LOG_LOGIC("Growing the arena to " << (chunk + 1) * VERTEX_ARENA_CHUNK << " vertices");
+        m_chunks.push_back(new Vertex[VERTEX_ARENA_CHUNK]);
+    }
+    Vertex* v = &m_chunks[chunk][m_next % VERTEX_ARENA_CHUNK];
+    m_next++;
+    v->Reset(lsa);
+    return v;
+}
+
+void
+VertexArena::Reset(void)
+{
+    NS_LOG_FUNCTION(this);
+    m_next = 0;
+}
+
 // ---------------------------------------------------------------------------
 //
 // RouteManagerLSDB Implementation
@@ -455,18 +585,6 @@ RouteManagerLSDB::~RouteManagerLSDB()
     m_database.clear();
 }
 
-void
-RouteManagerLSDB::Initialize()
-{
-    NS_LOG_FUNCTION(this);
-    LSDBMap_t::iterator i;
-    for (i = m_database.begin(); i != m_database.end(); i++)
-    {
-        LSA* temp = i->second;
-        temp->SetStatus(LSA::LSA_SPF_NOT_EXPLORED);
-    }
-}
-
 void
 RouteManagerLSDB::Insert(Ipv4Address addr, LSA* lsa)
 {
@@ -475,9 +593,9 @@ RouteManagerLSDB::Insert(Ipv4Address addr, LSA* lsa)
     {
         m_extdatabase.push_back(lsa);
     }
-    else
+    else if (m_database.insert(LSDBPair_t(addr, lsa)).second)
     {
-        m_database.insert(LSDBPair_t(addr, lsa));
+        lsa->SetIndex(m_database.size() - 1);
     }
 }
 
@@ -537,26 +655,168 @@ RouteManagerLSDB::GetLSAByLinkData(Ipv4Address addr) const
     return 0;
 }
 
+uint32_t
+RouteManagerLSDB::GetNLSAs() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_database.size();
+}
+
+std::vector<LSA*>
+RouteManagerLSDB::GetLSAs() const
+{
+    NS_LOG_FUNCTION(this);
+    std::vector<LSA*> lsas;
+    lsas.reserve(m_database.size());
+    for (LSDBMap_t::const_iterator i = m_database.begin(); i != m_database.end(); i++)
+    {
+        lsas.push_back(i->second);
+    }
+    return lsas;
+}
+
 // ---------------------------------------------------------------------------
 //
 // RouteManagerImpl Implementation
 //
 // ---------------------------------------------------------------------------
 
+/**
+ * \brief The LSDB compiled into a compressed sparse row graph.
+ *
+ * The routers are numbered densely, and the links of router v are the
+ * entries [m_outBegin[v], m_outBegin[v + 1]) of the m_out arrays, in the
+ * order of its LSA.  The SPF calculations on it read a few contiguous arrays
+ * instead of walking the LSAs and their link records.
+ */
+struct RouteManagerImpl::SPFGraph
+{
+    std::vector<LSA*> m_lsas; //!< router LSA of each vertex
+    /// router ID to vertex
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_index;
+    std::vector<uint32_t> m_outBegin;      //!< first link of each vertex, then the end
+    std::vector<uint32_t> m_outTo;         //!< destination vertex of each link
+    std::vector<uint32_t> m_outMetric;     //!< metric of each link
+    std::vector<Ipv4Address> m_outNextHop; //!< next hop of the source vertex on each link
+    std::vector<int32_t> m_outIface;       //!< interface of the source vertex on each link
+    std::vector<uint32_t> m_inBegin;       //!< first incoming link of each vertex, then the end
+    std::vector<uint32_t> m_inFrom;        //!< source vertex of each incoming link
+    std::vector<uint32_t> m_inMetric;      //!< metric of each incoming link
+    std::vector<uint32_t> m_hostBegin;     //!< first host address of each vertex, then the end
+    std::vector<Ipv4Address> m_hosts;      //!< local address of each point-to-point link
+    std::vector<uint32_t> m_stubBegin;     //!< first stub network of each vertex, then the end
+    std::vector<Ipv4Address> m_stubNetworks; //!< address of each stub network
+    std::vector<Ipv4Mask> m_stubMasks;       //!< mask of each stub network
+};
+
+/**
+ * \brief Scratch space of GraphSPFCalculate (), reused across the jobs of a
+ * route manager or worker.
+ */
+struct RouteManagerImpl::SPFGraphState
+{
+    std::vector<uint32_t> m_distance;                     //!< distance from the root
+    std::vector<bool> m_settled;                          //!< vertex in the SPF tree
+    std::vector<uint32_t> m_order;                        //!< vertices, as they joined the tree
+    std::vector<std::vector<Vertex::NodeExit_t>> m_exits; //!< exit directions of each vertex
+};
+
+/// (distance, vertex) entry of the priority queues of the SPF graph calculations
+typedef std::pair<uint32_t, uint32_t> SPFGraphQueueItem_t;
+/// priority queue of the SPF graph calculations, closest vertex first
+typedef std::priority_queue<SPFGraphQueueItem_t,
+                            std::vector<SPFGraphQueueItem_t>,
+                            std::greater<SPFGraphQueueItem_t>>
+    SPFGraphQueue_t;
+
+/**
+ * \brief Scratch space of the reverse SPF calculation of one destination.
+ */
+struct RouteManagerImpl::ReverseSPFState
+{
+    std::vector<uint32_t> m_distance;              //!< distance to the destination
+    std::vector<uint32_t> m_order;                 //!< routers reaching it, closest first
+    std::vector<uint32_t> m_idom;                  //!< immediate dominator
+    std::vector<uint32_t> m_depth;                 //!< depth in the dominator tree
+    std::vector<uint32_t> m_size;                  //!< size of the dominator subtree
+    std::vector<uint32_t> m_first;                 //!< preorder index in the dominator tree
+    std::vector<std::vector<uint32_t>> m_children; //!< children in the dominator tree
+    std::vector<uint32_t> m_preorder;              //!< routers in dominator tree preorder
+    std::vector<uint32_t> m_replacement;           //!< distance avoiding the excluded router
+    std::vector<Vertex::NodeExit_t> m_exits;       //!< exit directions of a job
+};
+
+/**
+ * \brief Routes computed for one destination router, tagged with their job.
+ */
+struct RouteManagerImpl::ReverseSPFResult
+{
+    std::vector<std::pair<uint32_t, RouteRecord>> m_hostRoutes;    //!< (job, host route)
+    std::vector<std::pair<uint32_t, RouteRecord>> m_networkRoutes; //!< (job, network route)
+};
+
+/**
+ * \brief Input and output of the reverse SPF engine, shared by its workers.
+ */
+struct RouteManagerImpl::ReverseSPFContext
+{
+    const SPFGraph* m_graph;                     //!< the graph
+    const std::vector<SPFJob>* m_jobs;           //!< the jobs
+    std::vector<std::vector<uint32_t>> m_jobsOf; //!< jobs to compute, by router index
+    std::vector<uint32_t> m_neighbor;            //!< router index of the neighbor of each job
+    std::vector<ReverseSPFResult> m_results;     //!< results, by destination index
+    std::vector<bool> m_resolved;                //!< destinations computed, in lazy mode
+};
+
 RouteManagerImpl::RouteManagerImpl()
-    : m_spfroot(0)
+    : m_spfroot(0),
+      m_nNodes(0),
+      m_spfEpoch(0),
+      m_routes(0),
+      m_graph(0),
+      m_graphState(0),
+      m_lazy(0),
+      m_jobsTracked(false),
+      m_compressedTables(false),
+      m_nResolved(0),
+      m_nUpdates(0),
+      m_nAvoidedUpdates(0)
 {
     NS_LOG_FUNCTION(this);
     m_lsdb = new RouteManagerLSDB();
+    m_manager = this;
+}
+
+RouteManagerImpl::RouteManagerImpl(const RouteManagerImpl* manager)
+    : m_spfroot(0),
+      m_lsdb(manager->m_lsdb),
+      m_manager(manager),
+      m_nNodes(0),
+      m_spfEpoch(0),
+      m_routes(0),
+      m_graph(0),
+      m_graphState(0),
+      m_lazy(0),
+      m_jobsTracked(false),
+      m_compressedTables(false),
+      m_nResolved(0),
+      m_nUpdates(0),
+      m_nAvoidedUpdates(0)
+{
+    NS_LOG_FUNCTION(this << manager);
 }
 
 RouteManagerImpl::~RouteManagerImpl()
 {
     NS_LOG_FUNCTION(this);
-    if (m_lsdb)
+    // workers only borrow the LSDB and the SPF graph of their manager
+    if (m_lsdb && m_manager == this)
     {
         delete m_lsdb;
     }
+    delete m_graph;
+    delete m_graphState;
+    delete m_lazy;
 }
 
 void
@@ -568,35 +828,30 @@ RouteManagerImpl::DebugUseLsdb(RouteManagerLSDB* lsdb)
         delete m_lsdb;
     }
     m_lsdb = lsdb;
+    delete m_lazy;
+    m_lazy = 0;
+    delete m_graph;
+    m_graph = 0;
 }
 
 void
 RouteManagerImpl::DeleteRoutes()
 {
     NS_LOG_FUNCTION(this);
-    NodeList::Iterator listEnd = NodeList::End();
-    for (NodeList::Iterator i = NodeList::Begin(); i != listEnd; i++)
+    //
+    // The routes were installed on the routers indexed by the last
+    // BuildRoutingDatabase ().
+    //
+    for (RouterInfos_t::const_iterator i = m_routers.begin(); i != m_routers.end(); i++)
     {
-        Ptr<Node> node = *i;
-        Ptr<Router> router = node->GetObject<Router>();
-        if (!router)
-        {
-            continue;
-        }
-        Ptr<GBR> gr = router->GetRoutingProtocol();
-        uint32_t j = 0;
-        uint32_t nRoutes = gr->GetNRoutes();
-        NS_LOG_LOGIC("Deleting " << gr->GetNRoutes() << " routes from node " << node->GetId());
-        // Each time we delete route 0, the route index shifts downward
-        // We can delete all routes if we delete the route numbered 0
-        // nRoutes times
-        for (j = 0; j < nRoutes; j++)
-        {
-            NS_LOG_LOGIC("Deleting global route " << j << " from node " << node->GetId());
-            gr->RemoveRoute(0);
-        }
-        NS_LOG_LOGIC("Deleted " << j << " global routes from node " << node->GetId());
+        RemoveRoutes(i->second.m_gbr);
     }
+    // the jobs and the SPF graph refer to the LSDB deleted below
+    m_jobs.clear();
+    delete m_lazy;
+    m_lazy = 0;
+    delete m_graph;
+    m_graph = 0;
     if (m_lsdb)
     {
         NS_LOG_LOGIC("Deleting LSDB, creating new one");
@@ -605,6 +860,24 @@ RouteManagerImpl::DeleteRoutes()
     }
 }
 
+void
+RouteManagerImpl::RemoveRoutes(Ptr<GBR> gr)
+{
+    NS_LOG_FUNCTION(this << gr);
+    uint32_t j = 0;
+    uint32_t nRoutes = gr->GetNRoutes();
+    NS_LOG_LOGIC("Deleting " << gr->GetNRoutes() << " routes");
+    // Each time we delete route 0, the route index shifts downward
+    // We can delete all routes if we delete the route numbered 0
+    // nRoutes times
+    for (j = 0; j < nRoutes; j++)
+    {
+        NS_LOG_LOGIC("Deleting global route " << j);
+        gr->RemoveRoute(0);
+    }
+    NS_LOG_LOGIC("Deleted " << j << " global routes");
+}
+
 //
 // In order to build the routing database, we need to walk the list of nodes
 // in the system and look for those that support the Router interface.
@@ -618,6 +891,7 @@ void
 RouteManagerImpl::BuildRoutingDatabase()
 {
     NS_LOG_FUNCTION(this);
+    BuildIndexes();
     //
     // Walk the list of nodes looking for the Router Interface.  Nodes with
     // global router interfaces are, not too surprisingly, our routers.
@@ -661,6 +935,21 @@ RouteManagerImpl::BuildRoutingDatabase()
             m_lsdb->Insert(lsa->GetLinkStateId(), lsa);
         }
     }
+
+    //
+    // Compile the database for the SPF calculations.  Topologies the graph
+    // does not model are computed on the LSDB itself.
+    //
+    delete m_lazy;
+    m_lazy = 0;
+    delete m_graph;
+    m_graph = new SPFGraph();
+    if (!BuildSPFGraph(*m_graph))
+    {
+        NS_LOG_LOGIC("No SPF graph, the SPF calculations run on the LSDB");
+        delete m_graph;
+        m_graph = 0;
+    }
 }
 
 //
@@ -700,49 +989,206 @@ void
 RouteManagerImpl::InitializeRoutes()
 {
     NS_LOG_FUNCTION(this);
-    //
-    // Walk the list of nodes in the system.
-    //
     NS_LOG_INFO("About to start SPF calculation");
-    NodeList::Iterator listEnd = NodeList::End();
-    for (NodeList::Iterator i = NodeList::Begin(); i != listEnd; i++)
+    InitializeProtocols();
+    std::vector<SPFJob> jobs;
+    BuildSPFJobs(jobs);
+
+    m_jobsTracked = true;
+    BooleanValue lazy;
+    g_lazyRoutes.GetValue(lazy);
+    EnumValue engine;
+    g_routeEngine.GetValue(engine);
+    if (lazy.Get() && !m_graph)
+    {
+        NS_LOG_WARN("Topology not supported by the lazy routes, computing all the routes");
+    }
+    if (lazy.Get() && m_graph)
     {
-        Ptr<Node> node = *i;
         //
-        // Look for the Router interface that indicates that the node is
-        // participating in routing.
+        // Only the default routes of the stub nodes are installed now; every
+        // host route, the routes to the neighbors included, is installed by
+        // ResolveRoutesTo () the first time its destination is looked up.
         //
-        Ptr<Router> rtr = node->GetObject<Router>();
-        if (!rtr)
+        NS_ASSERT(!m_lazy);
+        m_jobsTracked = false;
+        m_lazy = new ReverseSPFContext();
+        BuildReverseSPFContext(jobs, *m_lazy);
+        m_lazy->m_resolved.assign(m_graph->m_lsas.size(), false);
+    }
+    else if (engine.Get() == REVERSE_SPF_ENGINE)
+    {
+        RunReverseSPF(jobs);
+    }
+    else
+    {
+        RunSPFJobs(jobs);
+    }
+
+    //
+    // Install the routes in job order, which is the order the calculations
+    // would have installed them in had they all run on this thread.
+    //
+    SelectTableLayout();
+    for (std::vector<SPFJob>::const_iterator j = jobs.begin(); j != jobs.end(); j++)
+    {
+        for (RouteRecords_t::const_iterator r = j->m_routes.begin(); r != j->m_routes.end(); r++)
         {
-            NS_LOG_ERROR("Router objective is nullptr for node: " << node->GetId());
+            if (m_lazy && r->m_type == RouteRecord::HostRoute)
+            {
+                // installed by ResolveRoutesTo (), neighbors included
+                continue;
+            }
+            InstallRoute(*r);
         }
+    }
 
-        uint32_t systemId = Simulator::GetSystemId();
-        // Ignore nodes that are not assigned to our systemId (distributed sim)
-        if (node->GetSystemId() != systemId)
+    //
+    // Keep the jobs, so that UpdateRoutes () can reuse the routes of the
+    // calculations a topology change does not affect.
+    //
+    m_jobs.swap(jobs);
+    if (m_lazy)
+    {
+        m_lazy->m_jobs = &m_jobs;
+    }
+    NS_LOG_INFO("Finished SPF calculation");
+}
+
+bool
+RouteManagerImpl::ResolveRoutesTo(Ipv4Address dest)
+{
+    NS_LOG_FUNCTION(this << dest);
+    if (!m_lazy)
+    {
+        return false;
+    }
+    HostRouteIndex::Aliases::const_iterator owner = m_routerIds.find(dest);
+    if (owner == m_routerIds.end())
+    {
+        NS_LOG_LOGIC("No router owns " << dest);
+        return false;
+    }
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator router =
+        m_graph->m_index.find(owner->second);
+    if (router == m_graph->m_index.end() || m_lazy->m_resolved[router->second])
+    {
+        return false;
+    }
+    m_lazy->m_resolved[router->second] = true;
+
+    NS_LOG_LOGIC("Computing the routes to router " << owner->second);
+    ReverseSPFState state;
+    ReverseSPFResult& result = m_lazy->m_results[router->second];
+    ReverseSPFDestination(m_lazy, router->second, state);
+    //
+    // Add the routes of the jobs rooted at the destination, i.e. the routes
+    // of its neighbors to it, and install them all in job order, the order
+    // InitializeRoutes () would have installed them in.  They are not kept
+    // once installed.
+    //
+    const std::vector<SPFJob>& jobs = *m_lazy->m_jobs;
+    for (uint32_t j = 0; j < jobs.size(); j++)
+    {
+        if (jobs[j].m_root != owner->second)
         {
             continue;
         }
+        const RouteRecords_t& routes = jobs[j].m_routes;
+        for (RouteRecords_t::const_iterator r = routes.begin(); r != routes.end(); r++)
+        {
+            if (r->m_type == RouteRecord::HostRoute)
+            {
+                result.m_hostRoutes.push_back(std::make_pair(j, *r));
+            }
+        }
+    }
+    std::stable_sort(result.m_hostRoutes.begin(), result.m_hostRoutes.end(), &CompareJobRoutes);
+    for (uint32_t i = 0; i < result.m_hostRoutes.size(); i++)
+    {
+        InstallRoute(result.m_hostRoutes[i].second);
+    }
+    for (uint32_t i = 0; i < result.m_networkRoutes.size(); i++)
+    {
+        InstallRoute(result.m_networkRoutes[i].second);
+    }
+    m_nResolved++;
+    std::vector<std::pair<uint32_t, RouteRecord>>().swap(result.m_hostRoutes);
+    std::vector<std::pair<uint32_t, RouteRecord>>().swap(result.m_networkRoutes);
+    return true;
+}
+
+uint32_t
+RouteManagerImpl::GetNResolved() const
+{
+    return m_nResolved;
+}
 
+void
+RouteManagerImpl::InitializeProtocols()
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t systemId = Simulator::GetSystemId();
+    NodeList::Iterator listEnd = NodeList::End();
+    for (NodeList::Iterator i = NodeList::Begin(); i != listEnd; i++)
+    {
+        Ptr<Node> node = *i;
+        Ptr<Router> rtr = node->GetObject<Router>();
+        if (!rtr || node->GetSystemId() != systemId)
+        {
+            continue;
+        }
         // ---------- Initialize Neighbor Information exchange ----
         Ptr<GBR> gbr = rtr->GetRoutingProtocol();
         if (!gbr)
         {
             NS_LOG_ERROR("GBR protocol is nullptr for node:" << node->GetId());
+            continue;
         }
         gbr->DoInitialize();
+    }
+}
 
-        // -------- Initialize routing table --------------
-        //
-        // if the node has a GBR router interface, then run the GBR routing
-        // algorithms.
-        //
-        Vertex* v;
-        LSA* w_lsa = 0;
-        LinkRecord* l = 0;
-        uint32_t numRecordsInVertex = 0;
-        v = new Vertex(m_lsdb->GetLSA(rtr->GetRouterId()));
+void
+RouteManagerImpl::BuildSPFJobs(std::vector<SPFJob>& jobs)
+{
+    NS_LOG_FUNCTION(this);
+    //
+    // Walk the list of nodes in the system.  The SPF calculations to run are
+    // collected here, on the simulation thread, and run afterwards.
+    //
+    NodeList::Iterator listEnd = NodeList::End();
+    for (NodeList::Iterator i = NodeList::Begin(); i != listEnd; i++)
+    {
+        Ptr<Node> node = *i;
+        //
+        // Look for the Router interface that indicates that the node is
+        // participating in routing.
+        //
+        Ptr<Router> rtr = node->GetObject<Router>();
+        if (!rtr)
+        {
+            NS_LOG_ERROR("Router objective is nullptr for node: " << node->GetId());
+        }
+
+        uint32_t systemId = Simulator::GetSystemId();
+        // Ignore nodes that are not assigned to our systemId (distributed sim)
+        if (node->GetSystemId() != systemId)
+        {
+            continue;
+        }
+
+        // -------- Initialize routing table --------------
+        //
+        // if the node has a GBR router interface, then run the GBR routing
+        // algorithms.
+        //
+        Vertex* v;
+        LSA* w_lsa = 0;
+        LinkRecord* l = 0;
+        uint32_t numRecordsInVertex = 0;
+        m_vertexArena.Reset();
+        v = m_vertexArena.Allocate(m_lsdb->GetLSA(rtr->GetRouterId()));
         //
         // V points to a Router-LSA or Network-LSA
         // Loop over the links in router LSA or attached routers in Network LSA
@@ -755,104 +1201,1485 @@ RouteManagerImpl::InitializeRoutes()
         {
             numRecordsInVertex = v->GetLSA()->GetNAttachedRouters();
         }
-        for (uint32_t i = 0; i < numRecordsInVertex; i++)
+        for (uint32_t i = 0; i < numRecordsInVertex; i++)
+        {
+            // std::cout << "i = " << i << std::endl;
+            if (v->GetVertexType() == Vertex::VertexRouter)
+            {
+                NS_LOG_LOGIC("Examining link " << i << " of " << v->GetVertexId() << "'s "
+                                               << v->GetLSA()->GetNLinkRecords()
+                                               << " link records");
+                //
+                // (a) If this is a link to a stub network, examine the next link in V's LSA.
+                // Links to stub networks will be considered in the second stage of the
+                // shortest path calculation.
+                //
+                l = v->GetLSA()->GetLinkRecord(i);
+                NS_ASSERT(l != 0);
+                if (l->GetLinkType() == LinkRecord::StubNetwork)
+                {
+                    NS_LOG_LOGIC("Found a Stub record to " << l->GetLinkId());
+                    continue;
+                }
+                //
+                // (b) Otherwise, W is a transit vertex (router or transit network).  Look up
+                // the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
+                // database.
+                //
+                if (l->GetLinkType() == LinkRecord::PointToPoint)
+                {
+                    //
+                    // Lookup the link state advertisement of the new link -- we call it <w> in
+                    // the link state database.
+                    //
+                    w_lsa = m_lsdb->GetLSA(l->GetLinkId());
+                    if (!w_lsa)
+                    {
+                        NS_LOG_ERROR("LSA not found for Linkid");
+                    }
+                    NS_ASSERT(w_lsa);
+
+                    NS_LOG_LOGIC("Found a P2P record from " << v->GetVertexId() << " to "
+                                                            << w_lsa->GetLinkStateId());
+                    LinkRecord* linkRemote = 0;
+                    Vertex* w = m_vertexArena.Allocate(w_lsa);
+                    linkRemote = SPFGetNextLink(w, v, linkRemote);
+                    int32_t Iface = -1;
+                    InterfaceInfos_t::const_iterator local = m_interfaces.find(l->GetLinkData());
+                    if (local != m_interfaces.end() && local->second.m_nodeId == node->GetId())
+                    {
+                        Iface = local->second.m_interface;
+                    }
+
+                    SPFJob job;
+                    job.m_root = w_lsa->GetLinkStateId();
+                    job.m_initRoot = rtr->GetRouterId();
+                    job.m_link = linkRemote;
+                    job.m_iface = Iface;
+                    m_routes = &job.m_routes;
+
+                    //
+                    // Host routes to the other interfaces of the neighbor, to
+                    // the first address of each.
+                    //
+                    RouterInfos_t::const_iterator remote = m_routers.find(job.m_root);
+                    if (remote != m_routers.end())
+                    {
+                        const std::vector<std::pair<int32_t, Ipv4Address>>& addresses =
+                            remote->second.m_addresses;
+                        int32_t lastIfc = 0;
+                        for (uint32_t a = 0; a < addresses.size(); a++)
+                        {
+                            if (addresses[a].first == lastIfc)
+                            {
+                                continue;
+                            }
+                            lastIfc = addresses[a].first;
+                            AddRouteRecord(RouteRecord::HostRoute,
+                                           rtr->GetRouterId(),
+                                           addresses[a].second,
+                                           Ipv4Mask::GetOnes(),
+                                           linkRemote->GetLinkData(),
+                                           Iface,
+                                           -1,
+                                           l->GetMetric());
+                        }
+                    }
+
+                    m_routes = 0;
+                    jobs.push_back(job);
+                }
+                else if (l->GetLinkType() == LinkRecord::TransitNetwork)
+                {
+                    w_lsa = m_lsdb->GetLSA(l->GetLinkId());
+                    NS_ASSERT(w_lsa);
+                    NS_LOG_LOGIC("Found a Transit record from " << v->GetVertexId() << " to "
+                                                                << w_lsa->GetLinkStateId());
+                    SPFJob job;
+                    job.m_root = w_lsa->GetLinkStateId();
+                    job.m_initRoot = rtr->GetRouterId();
+                    job.m_link = l;
+                    job.m_iface = i + 1;
+                    jobs.push_back(job);
+                }
+                else
+                {
+                    NS_ASSERT_MSG(0, "illegal Link Type");
+                }
+            }
+        }
+    }
+}
+
+//
+// Recompute the routes after a change of the topology, reusing the SPF
+// calculations the change cannot affect.  A calculation only reads the LSAs
+// of the vertices it adds to its tree and of their neighbors, which it
+// records in SPFJob::m_touched; if none of them changed, neither did its
+// routes.  The routing tables of the routers receiving a route from a
+// recomputed calculation are reinstalled whole, in job order, so they end up
+// exactly as a full recomputation would leave them.
+//
+void
+RouteManagerImpl::UpdateRoutes()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_jobsTracked || m_jobs.empty())
+    {
+        NS_LOG_LOGIC("No SPF calculation to reuse, recomputing every route");
+        DeleteRoutes();
+        BuildRoutingDatabase();
+        InitializeRoutes();
+        return;
+    }
+
+    //
+    // Build the new routing database next to the one the installed routes were
+    // computed from, and find the routers whose LSA or addresses changed.
+    //
+    RouteManagerLSDB* oldLsdb = m_lsdb;
+    RouterInfos_t oldRouters = m_routers;
+    m_lsdb = new RouteManagerLSDB();
+    BuildRoutingDatabase();
+    AddressSet_t changed;
+    if (!DiffRoutingDatabase(oldLsdb, oldRouters, changed))
+    {
+        NS_LOG_LOGIC("Topology change not supported incrementally, recomputing every route");
+        for (RouterInfos_t::const_iterator i = oldRouters.begin(); i != oldRouters.end(); i++)
+        {
+            RemoveRoutes(i->second.m_gbr);
+        }
+        m_jobs.clear();
+        delete oldLsdb;
+        InitializeRoutes();
+        return;
+    }
+    NS_LOG_LOGIC(changed.size() << " routers changed");
+
+    std::vector<SPFJob> jobs;
+    BuildSPFJobs(jobs);
+
+    //
+    // Pair each job with the job of the previous calculation over the same
+    // link, and keep its routes if it did not read a changed LSA.
+    //
+    typedef std::unordered_map<Ipv4Address, std::vector<uint32_t>, Ipv4AddressHash> JobsOf_t;
+    JobsOf_t oldJobsOf;
+    for (uint32_t j = 0; j < m_jobs.size(); j++)
+    {
+        oldJobsOf[m_jobs[j].m_initRoot].push_back(j);
+    }
+    std::vector<bool> oldUsed(m_jobs.size(), false);
+    std::vector<uint32_t> dirty;
+    AddressSet_t dirtyRouters;
+    for (uint32_t j = 0; j < jobs.size(); j++)
+    {
+        SPFJob& job = jobs[j];
+        uint32_t old = DISTINFINITY;
+        JobsOf_t::const_iterator candidates = oldJobsOf.find(job.m_initRoot);
+        if (candidates != oldJobsOf.end())
+        {
+            for (uint32_t k = 0; k < candidates->second.size() && old == DISTINFINITY; k++)
+            {
+                uint32_t o = candidates->second[k];
+                const SPFJob& oldJob = m_jobs[o];
+                if (!oldUsed[o] && oldJob.m_root == job.m_root && oldJob.m_iface == job.m_iface &&
+                    oldJob.m_link->GetLinkData() == job.m_link->GetLinkData() &&
+                    oldJob.m_link->GetMetric() == job.m_link->GetMetric())
+                {
+                    old = o;
+                }
+            }
+        }
+        if (old != DISTINFINITY)
+        {
+            oldUsed[old] = true;
+            SPFJob& oldJob = m_jobs[old];
+            bool affected = changed.count(oldJob.m_initRoot) > 0;
+            for (uint32_t k = 0; k < oldJob.m_touched.size() && !affected; k++)
+            {
+                affected = changed.count(oldJob.m_touched[k]) > 0;
+            }
+            if (!affected)
+            {
+                job.m_routes.swap(oldJob.m_routes);
+                job.m_touched.swap(oldJob.m_touched);
+                oldJob.m_routes.clear();
+                continue;
+            }
+        }
+        dirty.push_back(j);
+    }
+    for (uint32_t j = 0; j < m_jobs.size(); j++)
+    {
+        if (m_jobs[j].m_routes.empty())
+        {
+            // reused above, or produced no route
+            continue;
+        }
+        for (RouteRecords_t::const_iterator r = m_jobs[j].m_routes.begin();
+             r != m_jobs[j].m_routes.end();
+             r++)
+        {
+            dirtyRouters.insert(r->m_routerId);
+        }
+    }
+
+    std::vector<SPFJob> recompute;
+    recompute.reserve(dirty.size());
+    for (uint32_t k = 0; k < dirty.size(); k++)
+    {
+        recompute.push_back(jobs[dirty[k]]);
+    }
+    RunSPFJobs(recompute);
+    for (uint32_t k = 0; k < dirty.size(); k++)
+    {
+        SPFJob& job = jobs[dirty[k]];
+        job.m_routes.swap(recompute[k].m_routes);
+        job.m_touched.swap(recompute[k].m_touched);
+        for (RouteRecords_t::const_iterator r = job.m_routes.begin(); r != job.m_routes.end();
+             r++)
+        {
+            dirtyRouters.insert(r->m_routerId);
+        }
+    }
+
+    //
+    // Reinstall the tables of the routers a recomputed job adds routes to, or
+    // used to.
+    //
+    for (AddressSet_t::const_iterator i = dirtyRouters.begin(); i != dirtyRouters.end(); i++)
+    {
+        RouterInfos_t::const_iterator router = m_routers.find(*i);
+        if (router != m_routers.end())
+        {
+            RemoveRoutes(router->second.m_gbr);
+        }
+    }
+    for (std::vector<SPFJob>::const_iterator j = jobs.begin(); j != jobs.end(); j++)
+    {
+        for (RouteRecords_t::const_iterator r = j->m_routes.begin(); r != j->m_routes.end(); r++)
+        {
+            if (dirtyRouters.count(r->m_routerId) > 0)
+            {
+                InstallRoute(*r);
+            }
+        }
+    }
+    NS_LOG_INFO("Recomputed " << dirty.size() << " of " << jobs.size()
+                              << " SPF calculations, reinstalled the routes of "
+                              << dirtyRouters.size() << " routers");
+
+    m_jobs.swap(jobs);
+    delete oldLsdb;
+}
+
+bool
+RouteManagerImpl::SaveRoutingTables(std::string path) const
+{
+    NS_LOG_FUNCTION(this << path);
+    if (m_lazy || m_jobs.empty())
+    {
+        NS_LOG_WARN("No computed routes to save to " << path);
+        return false;
+    }
+    uint32_t nRoutes = 0;
+    for (std::vector<SPFJob>::const_iterator j = m_jobs.begin(); j != m_jobs.end(); j++)
+    {
+        nRoutes += j->m_routes.size();
+    }
+
+    std::string buffer;
+    buffer.reserve(SNAPSHOT_HEADER_SIZE + nRoutes * SNAPSHOT_RECORD_SIZE);
+    uint64_t hash = GetTopologyHash();
+    WriteSnapshotUint32(buffer, SNAPSHOT_MAGIC);
+    WriteSnapshotUint32(buffer, SNAPSHOT_VERSION);
+    WriteSnapshotUint32(buffer, static_cast<uint32_t>(hash));
+    WriteSnapshotUint32(buffer, static_cast<uint32_t>(hash >> 32));
+    WriteSnapshotUint32(buffer, nRoutes);
+    for (std::vector<SPFJob>::const_iterator j = m_jobs.begin(); j != m_jobs.end(); j++)
+    {
+        for (RouteRecords_t::const_iterator r = j->m_routes.begin(); r != j->m_routes.end(); r++)
+        {
+            WriteSnapshotUint32(buffer, r->m_type);
+            WriteSnapshotUint32(buffer, r->m_routerId.Get());
+            WriteSnapshotUint32(buffer, r->m_dest.Get());
+            WriteSnapshotUint32(buffer, r->m_mask.Get());
+            WriteSnapshotUint32(buffer, r->m_nextHop.Get());
+            WriteSnapshotUint32(buffer, r->m_interface);
+            WriteSnapshotUint32(buffer, r->m_nextInterface);
+            WriteSnapshotUint32(buffer, r->m_distance);
+        }
+    }
+
+    std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+    file.write(buffer.data(), buffer.size());
+    if (!file)
+    {
+        NS_LOG_WARN("Cannot write the routing tables to " << path);
+        return false;
+    }
+    NS_LOG_INFO("Saved " << nRoutes << " routes to " << path);
+    return true;
+}
+
+bool
+RouteManagerImpl::LoadRoutingTables(std::string path)
+{
+    NS_LOG_FUNCTION(this << path);
+    std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        NS_LOG_INFO("No routing tables snapshot at " << path);
+        return false;
+    }
+    std::streamoff size = file.tellg();
+    if (size < SNAPSHOT_HEADER_SIZE)
+    {
+        NS_LOG_WARN("Truncated routing tables snapshot " << path);
+        return false;
+    }
+    std::vector<char> buffer(size);
+    file.seekg(0);
+    file.read(buffer.data(), size);
+    if (!file)
+    {
+        NS_LOG_WARN("Cannot read the routing tables snapshot " << path);
+        return false;
+    }
+
+    const char* data = buffer.data();
+    if (ReadSnapshotUint32(data) != SNAPSHOT_MAGIC ||
+        ReadSnapshotUint32(data + 4) != SNAPSHOT_VERSION)
+    {
+        NS_LOG_WARN("Not a routing tables snapshot of version " << SNAPSHOT_VERSION << ": "
+                                                                << path);
+        return false;
+    }
+    uint64_t hash = ReadSnapshotUint32(data + 8);
+    hash |= static_cast<uint64_t>(ReadSnapshotUint32(data + 12)) << 32;
+    if (hash != GetTopologyHash())
+    {
+        NS_LOG_WARN("Routing tables snapshot " << path << " is of another topology");
+        return false;
+    }
+    uint32_t nRoutes = ReadSnapshotUint32(data + 16);
+    if (static_cast<uint64_t>(size) !=
+        SNAPSHOT_HEADER_SIZE + static_cast<uint64_t>(nRoutes) * SNAPSHOT_RECORD_SIZE)
+    {
+        NS_LOG_WARN("Truncated routing tables snapshot " << path);
+        return false;
+    }
+    RouteRecords_t routes(nRoutes);
+    for (uint32_t i = 0; i < nRoutes; i++)
+    {
+        const char* record = data + SNAPSHOT_HEADER_SIZE + i * SNAPSHOT_RECORD_SIZE;
+        uint32_t type = ReadSnapshotUint32(record);
+        if (type > RouteRecord::ASExternalRoute)
+        {
+            NS_LOG_WARN("Unknown route type " << type << " in " << path);
+            return false;
+        }
+        RouteRecord& route = routes[i];
+        route.m_type = static_cast<RouteRecord::RouteType>(type);
+        route.m_routerId = Ipv4Address(ReadSnapshotUint32(record + 4));
+        route.m_dest = Ipv4Address(ReadSnapshotUint32(record + 8));
+        route.m_mask = Ipv4Mask(ReadSnapshotUint32(record + 12));
+        route.m_nextHop = Ipv4Address(ReadSnapshotUint32(record + 16));
+        route.m_interface = ReadSnapshotUint32(record + 20);
+        route.m_nextInterface = ReadSnapshotUint32(record + 24);
+        route.m_distance = ReadSnapshotUint32(record + 28);
+    }
+
+    //
+    // Initialize the routing protocols as InitializeRoutes () does, then
+    // install the routes in the order they were saved in.
+    //
+    InitializeProtocols();
+    SelectTableLayout();
+    for (RouteRecords_t::const_iterator r = routes.begin(); r != routes.end(); r++)
+    {
+        InstallRoute(*r);
+    }
+    m_jobs.clear();
+    m_jobsTracked = false;
+    NS_LOG_INFO("Loaded " << nRoutes << " routes from " << path);
+    return true;
+}
+
+uint64_t
+RouteManagerImpl::GetTopologyHash(void) const
+{
+    NS_LOG_FUNCTION(this);
+    uint64_t hash = 14695981039346656037ULL;
+    std::vector<LSA*> lsas = m_lsdb->GetLSAs();
+    for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs(); i++)
+    {
+        lsas.push_back(m_lsdb->GetExtLSA(i));
+    }
+    hash = HashUint32(hash, lsas.size());
+    for (std::vector<LSA*>::const_iterator i = lsas.begin(); i != lsas.end(); i++)
+    {
+        const LSA* lsa = *i;
+        hash = HashUint32(hash, lsa->GetLSType());
+        hash = HashUint32(hash, lsa->GetLinkStateId().Get());
+        hash = HashUint32(hash, lsa->GetAdvertisingRouter().Get());
+        hash = HashUint32(hash, lsa->GetNetworkLSANetworkMask().Get());
+        hash = HashUint32(hash, lsa->GetNLinkRecords());
+        for (uint32_t j = 0; j < lsa->GetNLinkRecords(); j++)
+        {
+            const LinkRecord* l = lsa->GetLinkRecord(j);
+            hash = HashUint32(hash, l->GetLinkType());
+            hash = HashUint32(hash, l->GetLinkId().Get());
+            hash = HashUint32(hash, l->GetLinkData().Get());
+            hash = HashUint32(hash, l->GetMetric());
+        }
+        hash = HashUint32(hash, lsa->GetNAttachedRouters());
+        for (uint32_t j = 0; j < lsa->GetNAttachedRouters(); j++)
+        {
+            hash = HashUint32(hash, lsa->GetAttachedRouter(j).Get());
+        }
+        //
+        // The routes also depend on the interfaces the addresses of the
+        // router are assigned to.
+        //
+        RouterInfos_t::const_iterator router = m_routers.find(lsa->GetLinkStateId());
+        if (lsa->GetLSType() != LSA::RouterLSA || router == m_routers.end())
+        {
+            continue;
+        }
+        const std::vector<std::pair<int32_t, Ipv4Address>>& addresses = router->second.m_addresses;
+        hash = HashUint32(hash, addresses.size());
+        for (uint32_t j = 0; j < addresses.size(); j++)
+        {
+            hash = HashUint32(hash, addresses[j].first);
+            hash = HashUint32(hash, addresses[j].second.Get());
+        }
+    }
+    return hash;
+}
+
+void
+RouteManagerImpl::SelectTableLayout(void)
+{
+    NS_LOG_FUNCTION(this);
+    BooleanValue compressed;
+    g_compressedTables.GetValue(compressed);
+    m_compressedTables = compressed.Get();
+    for (RouterInfos_t::const_iterator i = m_routers.begin(); i != m_routers.end(); i++)
+    {
+        i->second.m_gbr->SetHostRouteAliases(m_compressedTables ? &m_routerIds : nullptr);
+    }
+}
+
+void
+RouteManagerImpl::ScheduleUpdateRoutes()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_updateEvent.IsRunning())
+    {
+        m_nAvoidedUpdates++;
+        NS_LOG_LOGIC("Route update already scheduled, " << m_nAvoidedUpdates
+                                                        << " updates avoided so far");
+        return;
+    }
+    TimeValue holdDown;
+    g_routeHoldDown.GetValue(holdDown);
+    m_updateEvent = Simulator::Schedule(holdDown.Get(), &RouteManagerImpl::DoUpdateRoutes, this);
+}
+
+void
+RouteManagerImpl::DoUpdateRoutes()
+{
+    NS_LOG_FUNCTION(this);
+    m_nUpdates++;
+    UpdateRoutes();
+}
+
+uint32_t
+RouteManagerImpl::GetNUpdates() const
+{
+    return m_nUpdates;
+}
+
+uint32_t
+RouteManagerImpl::GetNAvoidedUpdates() const
+{
+    return m_nAvoidedUpdates;
+}
+
+bool
+RouteManagerImpl::DiffRoutingDatabase(const RouteManagerLSDB* oldLsdb,
+                                      const RouterInfos_t& oldRouters,
+                                      AddressSet_t& changed) const
+{
+    NS_LOG_FUNCTION(this << oldLsdb);
+    if (oldLsdb->GetNumExtLSAs() > 0 || m_lsdb->GetNumExtLSAs() > 0)
+    {
+        return false;
+    }
+    std::vector<LSA*> lsas = m_lsdb->GetLSAs();
+    if (lsas.size() != oldLsdb->GetLSAs().size() || oldRouters.size() != m_routers.size())
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < lsas.size(); i++)
+    {
+        LSA* lsa = lsas[i];
+        LSA* oldLsa = oldLsdb->GetLSA(lsa->GetLinkStateId());
+        if (!oldLsa || lsa->GetLSType() != LSA::RouterLSA || oldLsa->GetLSType() != LSA::RouterLSA)
+        {
+            // network LSAs are found by address, not by router ID
+            return false;
+        }
+        bool same = (lsa->GetNLinkRecords() == oldLsa->GetNLinkRecords());
+        for (uint32_t j = 0; j < lsa->GetNLinkRecords() && same; j++)
+        {
+            LinkRecord* l = lsa->GetLinkRecord(j);
+            LinkRecord* oldL = oldLsa->GetLinkRecord(j);
+            same = (l->GetLinkType() == oldL->GetLinkType() &&
+                    l->GetLinkId() == oldL->GetLinkId() &&
+                    l->GetLinkData() == oldL->GetLinkData() &&
+                    l->GetMetric() == oldL->GetMetric());
+        }
+        if (!same)
+        {
+            NS_LOG_LOGIC("LSA of router " << lsa->GetLinkStateId() << " changed");
+            changed.insert(lsa->GetLinkStateId());
+        }
+    }
+    for (RouterInfos_t::const_iterator i = m_routers.begin(); i != m_routers.end(); i++)
+    {
+        RouterInfos_t::const_iterator old = oldRouters.find(i->first);
+        if (old == oldRouters.end() || old->second.m_gbr != i->second.m_gbr)
+        {
+            return false;
+        }
+        if (old->second.m_addresses != i->second.m_addresses)
+        {
+            NS_LOG_LOGIC("Addresses of router " << i->first << " changed");
+            changed.insert(i->first);
+        }
+    }
+    return true;
+}
+
+void
+RouteManagerImpl::BuildIndexes(void)
+{
+    NS_LOG_FUNCTION(this);
+    m_routers.clear();
+    m_interfaces.clear();
+    m_routerIds.clear();
+    m_nNodes = NodeList::GetNNodes();
+    m_routers.reserve(m_nNodes);
+    NodeList::Iterator listEnd = NodeList::End();
+    for (NodeList::Iterator i = NodeList::Begin(); i != listEnd; i++)
+    {
+        Ptr<Node> node = *i;
+        Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+        if (!ipv4)
+        {
+            continue;
+        }
+        for (uint32_t j = 0; j < ipv4->GetNInterfaces(); j++)
+        {
+            for (uint32_t k = 0; k < ipv4->GetNAddresses(j); k++)
+            {
+                InterfaceInfo info;
+                info.m_nodeId = node->GetId();
+                info.m_interface = j;
+                m_interfaces.insert(std::make_pair(ipv4->GetAddress(j, k).GetLocal(), info));
+            }
+        }
+
+        Ptr<Router> rtr = node->GetObject<Router>();
+        if (!rtr)
+        {
+            continue;
+        }
+        Ipv4Address routerId = rtr->GetRouterId();
+        if (m_routers.find(routerId) != m_routers.end())
+        {
+            continue;
+        }
+        RouterInfo& info = m_routers[routerId];
+        info.m_gbr = rtr->GetRoutingProtocol();
+        for (uint32_t j = 0; j < ipv4->GetNInterfaces(); j++)
+        {
+            for (uint32_t k = 0; k < ipv4->GetNAddresses(j); k++)
+            {
+                Ipv4Address address = ipv4->GetAddress(j, k).GetLocal();
+                info.m_addresses.push_back(std::make_pair(j, address));
+                if (!address.IsLocalhost())
+                {
+                    m_routerIds.insert(std::make_pair(address, routerId));
+                }
+            }
+        }
+    }
+    NS_LOG_LOGIC("Indexed " << m_routers.size() << " routers and " << m_interfaces.size()
+                            << " addresses");
+}
+
+void
+RouteManagerImpl::RunSPFJobs(std::vector<SPFJob>& jobs)
+{
+    NS_LOG_FUNCTION(this << jobs.size());
+    uint32_t nThreads = GetNThreads(jobs.size());
+    if (nThreads == 1)
+    {
+        for (std::vector<SPFJob>::iterator j = jobs.begin(); j != jobs.end(); j++)
+        {
+            RunSPFJob(*j);
+        }
+        return;
+    }
+
+    NS_LOG_LOGIC("Running " << jobs.size() << " SPF calculations on " << nThreads
+                            << " threads");
+    std::atomic<uint32_t> next(0);
+    std::vector<RouteManagerImpl*> workers;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < nThreads; t++)
+    {
+        workers.push_back(new RouteManagerImpl(this));
+        threads.push_back(
+            std::thread(&RouteManagerImpl::RunSPFWorker, workers.back(), &jobs, &next));
+    }
+    for (uint32_t t = 0; t < nThreads; t++)
+    {
+        threads[t].join();
+        delete workers[t];
+    }
+}
+
+uint32_t
+RouteManagerImpl::GetNThreads(uint32_t nJobs) const
+{
+    UintegerValue threadsValue;
+    g_spfThreads.GetValue(threadsValue);
+    uint32_t nThreads = threadsValue.Get();
+    if (nThreads == 0)
+    {
+        nThreads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    return std::max(std::min(nThreads, nJobs), 1U);
+}
+
+void
+RouteManagerImpl::RunSPFWorker(std::vector<SPFJob>* jobs, std::atomic<uint32_t>* next)
+{
+    for (uint32_t j = (*next)++; j < jobs->size(); j = (*next)++)
+    {
+        RunSPFJob((*jobs)[j]);
+    }
+}
+
+void
+RouteManagerImpl::RunSPFJob(SPFJob& job)
+{
+    m_routes = &job.m_routes;
+    if (m_manager->m_graph)
+    {
+        GraphSPFCalculate(job);
+        m_routes = 0;
+        return;
+    }
+    SPFCalculate(job.m_root, job.m_initRoot, job.m_link, job.m_iface);
+    m_routes = 0;
+
+    //
+    // Record the routers whose LSA the calculation read: the vertices of the
+    // tree and their neighbors, except the neighbors of the pruned router.
+    //
+    job.m_touched.clear();
+    job.m_touched.push_back(job.m_initRoot);
+    for (std::vector<LSA*>::const_iterator i = m_spfTree.begin(); i != m_spfTree.end(); i++)
+    {
+        LSA* lsa = *i;
+        if (lsa->GetLinkStateId() == job.m_initRoot)
+        {
+            continue;
+        }
+        job.m_touched.push_back(lsa->GetLinkStateId());
+        for (uint32_t j = 0; j < lsa->GetNLinkRecords(); j++)
+        {
+            LinkRecord* l = lsa->GetLinkRecord(j);
+            if (l->GetLinkType() != LinkRecord::StubNetwork)
+            {
+                job.m_touched.push_back(l->GetLinkId());
+            }
+        }
+    }
+}
+
+void
+RouteManagerImpl::AddRouteRecord(RouteRecord::RouteType type,
+                                 Ipv4Address routerId,
+                                 Ipv4Address dest,
+                                 Ipv4Mask mask,
+                                 Ipv4Address nextHop,
+                                 uint32_t iface,
+                                 uint32_t nextIface,
+                                 uint32_t distance)
+{
+    NS_ASSERT_MSG(m_routes, "RouteManagerImpl::AddRouteRecord (): no running job");
+    RouteRecord route;
+    route.m_type = type;
+    route.m_routerId = routerId;
+    route.m_dest = dest;
+    route.m_mask = mask;
+    route.m_nextHop = nextHop;
+    route.m_interface = iface;
+    route.m_nextInterface = nextIface;
+    route.m_distance = distance;
+    m_routes->push_back(route);
+}
+
+void
+RouteManagerImpl::InstallRoute(const RouteRecord& route)
+{
+    RouterInfos_t::const_iterator i = m_routers.find(route.m_routerId);
+    if (i == m_routers.end())
+    {
+        NS_LOG_LOGIC("No Router interface for router " << route.m_routerId);
+        return;
+    }
+    Ptr<GBR> gr = i->second.m_gbr;
+    NS_ASSERT(gr);
+    Ipv4Address dest = route.m_dest;
+    switch (route.m_type)
+    {
+    case RouteRecord::HostRoute:
+        if (m_compressedTables)
+        {
+            HostRouteIndex::Aliases::const_iterator owner = m_routerIds.find(dest);
+            if (owner != m_routerIds.end())
+            {
+                dest = owner->second;
+            }
+            if (gr->HasHostRouteTo(dest, route.m_nextHop, route.m_interface))
+            {
+                break;
+            }
+        }
+        gr->AddHostRouteTo(dest,
+                           route.m_nextHop,
+                           route.m_interface,
+                           route.m_nextInterface,
+                           route.m_distance);
+        break;
+    case RouteRecord::NetworkRoute:
+        gr->AddNetworkRouteTo(route.m_dest, route.m_mask, route.m_nextHop, route.m_interface);
+        break;
+    case RouteRecord::ASExternalRoute:
+        gr->AddASExternalRouteTo(route.m_dest, route.m_mask, route.m_nextHop, route.m_interface);
+        break;
+    }
+}
+
+void
+RouteManagerImpl::ResetSPFStatus(void)
+{
+    uint32_t nLsas = m_lsdb->GetNLSAs();
+    if (m_spfStatus.size() < nLsas)
+    {
+        SPFStamp stamp = {0, LSA::LSA_SPF_NOT_EXPLORED};
+        m_spfStatus.resize(nLsas, stamp);
+    }
+    m_spfEpoch++;
+    if (m_spfEpoch == 0)
+    {
+        // the counter wrapped, so the oldest stamps could match again
+        for (std::vector<SPFStamp>::iterator i = m_spfStatus.begin(); i != m_spfStatus.end();
+             i++)
+        {
+            i->m_epoch = 0;
+        }
+        m_spfEpoch = 1;
+    }
+    m_spfTree.clear();
+}
+
+LSA::SPFStatus
+RouteManagerImpl::GetSPFStatus(LSA* lsa) const
+{
+    uint32_t index = lsa->GetIndex();
+    if (index >= m_spfStatus.size() || m_spfStatus[index].m_epoch != m_spfEpoch)
+    {
+        return LSA::LSA_SPF_NOT_EXPLORED;
+    }
+    return m_spfStatus[index].m_status;
+}
+
+void
+RouteManagerImpl::SetSPFStatus(LSA* lsa, LSA::SPFStatus status)
+{
+    uint32_t index = lsa->GetIndex();
+    NS_ASSERT_MSG(index < m_spfStatus.size(), "RouteManagerImpl::SetSPFStatus (): LSA not in LSDB");
+    SPFStamp& stamp = m_spfStatus[index];
+    if (status == LSA::LSA_SPF_IN_SPFTREE &&
+        (stamp.m_epoch != m_spfEpoch || stamp.m_status != LSA::LSA_SPF_IN_SPFTREE))
+    {
+        m_spfTree.push_back(lsa);
+    }
+    stamp.m_epoch = m_spfEpoch;
+    stamp.m_status = status;
+}
+
+// ---------------------------------------------------------------------------
+//
+// SPF graph
+//
+// ---------------------------------------------------------------------------
+
+bool
+RouteManagerImpl::BuildSPFGraph(SPFGraph& graph) const
+{
+    NS_LOG_FUNCTION(this);
+    if (m_lsdb->GetNumExtLSAs() > 0)
+    {
+        NS_LOG_LOGIC("External LSAs are not supported");
+        return false;
+    }
+    graph.m_lsas = m_lsdb->GetLSAs();
+    uint32_t nVertices = graph.m_lsas.size();
+    for (uint32_t v = 0; v < nVertices; v++)
+    {
+        if (graph.m_lsas[v]->GetLSType() != LSA::RouterLSA)
+        {
+            NS_LOG_LOGIC("Network LSAs are not supported");
+            return false;
+        }
+        graph.m_index[graph.m_lsas[v]->GetLinkStateId()] = v;
+    }
+
+    graph.m_outBegin.assign(1, 0);
+    graph.m_hostBegin.assign(1, 0);
+    graph.m_stubBegin.assign(1, 0);
+    for (uint32_t v = 0; v < nVertices; v++)
+    {
+        LSA* lsa = graph.m_lsas[v];
+        for (uint32_t j = 0; j < lsa->GetNLinkRecords(); j++)
+        {
+            LinkRecord* l = lsa->GetLinkRecord(j);
+            if (l->GetLinkType() == LinkRecord::StubNetwork)
+            {
+                Ipv4Mask mask(l->GetLinkData().Get());
+                graph.m_stubNetworks.push_back(l->GetLinkId().CombineMask(mask));
+                graph.m_stubMasks.push_back(mask);
+                continue;
+            }
+            if (l->GetLinkType() != LinkRecord::PointToPoint || l->GetMetric() == 0)
+            {
+                NS_LOG_LOGIC("Only point-to-point links with a non-zero metric are supported");
+                return false;
+            }
+            std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator to =
+                graph.m_index.find(l->GetLinkId());
+            if (to == graph.m_index.end())
+            {
+                return false;
+            }
+            //
+            // The next hop is the address of the first link record of the
+            // neighbor back to this router, as SPFNexthopCalculation () finds
+            // it with SPFGetNextLink ().
+            //
+            LSA* remote = graph.m_lsas[to->second];
+            LinkRecord* linkRemote = 0;
+            for (uint32_t k = 0; k < remote->GetNLinkRecords() && !linkRemote; k++)
+            {
+                if (remote->GetLinkRecord(k)->GetLinkId() == lsa->GetLinkStateId())
+                {
+                    linkRemote = remote->GetLinkRecord(k);
+                }
+            }
+            if (!linkRemote)
+            {
+                return false;
+            }
+            graph.m_outTo.push_back(to->second);
+            graph.m_outMetric.push_back(l->GetMetric());
+            graph.m_outNextHop.push_back(linkRemote->GetLinkData());
+            graph.m_outIface.push_back(
+                FindRouterInterfaceId(lsa->GetLinkStateId(), l->GetLinkData()));
+            graph.m_hosts.push_back(l->GetLinkData());
+        }
+        graph.m_outBegin.push_back(graph.m_outTo.size());
+        graph.m_hostBegin.push_back(graph.m_hosts.size());
+        graph.m_stubBegin.push_back(graph.m_stubNetworks.size());
+    }
+
+    //
+    // Incoming links, grouped by destination with a counting sort.
+    //
+    uint32_t nLinks = graph.m_outTo.size();
+    graph.m_inBegin.assign(nVertices + 1, 0);
+    for (uint32_t k = 0; k < nLinks; k++)
+    {
+        graph.m_inBegin[graph.m_outTo[k] + 1]++;
+    }
+    for (uint32_t v = 0; v < nVertices; v++)
+    {
+        graph.m_inBegin[v + 1] += graph.m_inBegin[v];
+    }
+    graph.m_inFrom.resize(nLinks);
+    graph.m_inMetric.resize(nLinks);
+    std::vector<uint32_t> fill(graph.m_inBegin.begin(), graph.m_inBegin.end() - 1);
+    for (uint32_t v = 0; v < nVertices; v++)
+    {
+        for (uint32_t k = graph.m_outBegin[v]; k < graph.m_outBegin[v + 1]; k++)
+        {
+            uint32_t slot = fill[graph.m_outTo[k]]++;
+            graph.m_inFrom[slot] = v;
+            graph.m_inMetric[slot] = graph.m_outMetric[k];
+        }
+    }
+    NS_LOG_LOGIC("SPF graph of " << nVertices << " vertices and " << nLinks << " links");
+    return true;
+}
+
+void
+RouteManagerImpl::GraphSPFCalculate(SPFJob& job)
+{
+    NS_LOG_FUNCTION(this << job.m_root << job.m_initRoot);
+    const SPFGraph& graph = *m_manager->m_graph;
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator root =
+        graph.m_index.find(job.m_root);
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator initRoot =
+        graph.m_index.find(job.m_initRoot);
+    NS_ASSERT(root != graph.m_index.end() && initRoot != graph.m_index.end());
+    uint32_t n = root->second;
+
+    job.m_touched.clear();
+    job.m_touched.push_back(job.m_initRoot);
+    if (m_manager->m_nNodes > 0 && CheckForStubNode(job.m_root))
+    {
+        job.m_touched.push_back(job.m_root);
+        for (uint32_t k = graph.m_outBegin[n]; k < graph.m_outBegin[n + 1]; k++)
+        {
+            job.m_touched.push_back(graph.m_lsas[graph.m_outTo[k]]->GetLinkStateId());
+        }
+        return;
+    }
+
+    if (!m_graphState)
+    {
+        m_graphState = new SPFGraphState();
+    }
+    SPFGraphState& state = *m_graphState;
+    uint32_t nVertices = graph.m_lsas.size();
+    std::vector<uint32_t>& distance = state.m_distance;
+    std::vector<std::vector<Vertex::NodeExit_t>>& exits = state.m_exits;
+    distance.assign(nVertices, DISTINFINITY);
+    state.m_settled.assign(nVertices, false);
+    exits.resize(nVertices);
+    for (uint32_t v = 0; v < nVertices; v++)
+    {
+        exits[v].clear();
+    }
+    state.m_order.clear();
+
+    //
+    // Same calculation as SPFCalculate (): a Dijkstra calculation from the
+    // neighbor, starting at the metric of its link back to the router, with
+    // the router pruned.  The exit directions of a vertex are the union of
+    // those of its parents in the shortest path graph, sorted and unique.
+    //
+    state.m_settled[initRoot->second] = true;
+    distance[n] = job.m_link->GetMetric();
+    SPFGraphQueue_t candidate;
+    candidate.push(SPFGraphQueueItem_t(distance[n], n));
+    while (!candidate.empty())
+    {
+        SPFGraphQueueItem_t top = candidate.top();
+        candidate.pop();
+        uint32_t v = top.second;
+        if (state.m_settled[v] || top.first != distance[v])
+        {
+            continue;
+        }
+        state.m_settled[v] = true;
+        state.m_order.push_back(v);
+        for (uint32_t k = graph.m_outBegin[v]; k < graph.m_outBegin[v + 1]; k++)
+        {
+            uint32_t w = graph.m_outTo[k];
+            uint32_t d = distance[v] + graph.m_outMetric[k];
+            if (state.m_settled[w] || d > distance[w])
+            {
+                continue;
+            }
+            if (d < distance[w])
+            {
+                distance[w] = d;
+                exits[w].clear();
+                candidate.push(SPFGraphQueueItem_t(d, w));
+            }
+            if (v == n)
+            {
+                exits[w].push_back(Vertex::NodeExit_t(graph.m_outNextHop[k], graph.m_outIface[k]));
+            }
+            else
+            {
+                exits[w].insert(exits[w].end(), exits[v].begin(), exits[v].end());
+            }
+            std::sort(exits[w].begin(), exits[w].end());
+            exits[w].erase(std::unique(exits[w].begin(), exits[w].end()), exits[w].end());
+        }
+    }
+
+    //
+    // Host routes into the table of the router, then network routes into the
+    // table of the neighbor, like SPFIntraAddRouter () and SPFIntraAddStub ().
+    //
+    for (uint32_t i = 1; i < state.m_order.size(); i++)
+    {
+        uint32_t v = state.m_order[i];
+        NS_ASSERT(!exits[v].empty());
+        for (uint32_t k = graph.m_hostBegin[v]; k < graph.m_hostBegin[v + 1]; k++)
+        {
+            AddRouteRecord(RouteRecord::HostRoute,
+                           job.m_initRoot,
+                           graph.m_hosts[k],
+                           Ipv4Mask::GetOnes(),
+                           job.m_link->GetLinkData(),
+                           job.m_iface,
+                           exits[v][0].second,
+                           distance[v]);
+        }
+    }
+    for (uint32_t i = 1; i < state.m_order.size(); i++)
+    {
+        uint32_t v = state.m_order[i];
+        for (uint32_t k = graph.m_stubBegin[v]; k < graph.m_stubBegin[v + 1]; k++)
+        {
+            for (uint32_t e = 0; e < exits[v].size(); e++)
+            {
+                if (exits[v][e].second >= 0)
+                {
+                    AddRouteRecord(RouteRecord::NetworkRoute,
+                                   job.m_root,
+                                   graph.m_stubNetworks[k],
+                                   graph.m_stubMasks[k],
+                                   exits[v][e].first,
+                                   exits[v][e].second);
+                }
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < state.m_order.size(); i++)
+    {
+        uint32_t v = state.m_order[i];
+        job.m_touched.push_back(graph.m_lsas[v]->GetLinkStateId());
+        for (uint32_t k = graph.m_outBegin[v]; k < graph.m_outBegin[v + 1]; k++)
+        {
+            job.m_touched.push_back(graph.m_lsas[graph.m_outTo[k]]->GetLinkStateId());
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+//
+// Reverse SPF engine
+//
+// ---------------------------------------------------------------------------
+
+bool
+RouteManagerImpl::CompareJobRoutes(const std::pair<uint32_t, RouteRecord>& a,
+                                   const std::pair<uint32_t, RouteRecord>& b)
+{
+    return a.first < b.first;
+}
+
+void
+RouteManagerImpl::RunReverseSPF(std::vector<SPFJob>& jobs)
+{
+    NS_LOG_FUNCTION(this << jobs.size());
+    if (!m_graph)
+    {
+        NS_LOG_WARN("Topology not supported by the reverse SPF engine, "
+                    "running one SPF calculation per neighbor");
+        RunSPFJobs(jobs);
+        return;
+    }
+    // the jobs do not record the LSAs their routes depend on
+    m_jobsTracked = false;
+
+    ReverseSPFContext context;
+    BuildReverseSPFContext(jobs, context);
+    uint32_t nRouters = m_graph->m_lsas.size();
+
+    uint32_t nThreads = GetNThreads(nRouters);
+    std::atomic<uint32_t> next(0);
+    if (nThreads == 1)
+    {
+        RunReverseSPFWorker(&context, &next);
+    }
+    else
+    {
+        NS_LOG_LOGIC("Running " << nRouters << " reverse SPF calculations on " << nThreads
+                                << " threads");
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < nThreads; t++)
+        {
+            threads.push_back(std::thread(&RouteManagerImpl::RunReverseSPFWorker, &context, &next));
+        }
+        for (uint32_t t = 0; t < nThreads; t++)
+        {
+            threads[t].join();
+        }
+    }
+
+    //
+    // Hand the routes to their jobs, host routes first like SPFCalculate ().
+    // A job has at most one route per destination address, so the candidate
+    // routes of a destination keep the order of the jobs.
+    //
+    for (uint32_t dest = 0; dest < nRouters; dest++)
+    {
+        const ReverseSPFResult& result = context.m_results[dest];
+        for (uint32_t i = 0; i < result.m_hostRoutes.size(); i++)
+        {
+            jobs[result.m_hostRoutes[i].first].m_routes.push_back(result.m_hostRoutes[i].second);
+        }
+    }
+    for (uint32_t dest = 0; dest < nRouters; dest++)
+    {
+        const ReverseSPFResult& result = context.m_results[dest];
+        for (uint32_t i = 0; i < result.m_networkRoutes.size(); i++)
+        {
+            jobs[result.m_networkRoutes[i].first].m_routes.push_back(
+                result.m_networkRoutes[i].second);
+        }
+    }
+}
+
+void
+RouteManagerImpl::BuildReverseSPFContext(std::vector<SPFJob>& jobs, ReverseSPFContext& context)
+{
+    NS_LOG_FUNCTION(this << jobs.size());
+    NS_ASSERT(m_graph);
+    const SPFGraph& graph = *m_graph;
+    uint32_t nRouters = graph.m_lsas.size();
+    context.m_graph = &graph;
+    context.m_jobs = &jobs;
+    context.m_jobsOf.assign(nRouters, std::vector<uint32_t>());
+    context.m_neighbor.assign(jobs.size(), 0);
+    context.m_results.resize(nRouters);
+    for (uint32_t j = 0; j < jobs.size(); j++)
+    {
+        //
+        // Same short cut as SPFCalculate () when the neighbor is a stub node:
+        // install its default route instead of computing any.
+        //
+        m_routes = &jobs[j].m_routes;
+        bool stub = m_nNodes > 0 && CheckForStubNode(jobs[j].m_root);
+        m_routes = 0;
+        if (stub)
+        {
+            continue;
+        }
+        std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator root =
+            graph.m_index.find(jobs[j].m_root);
+        std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator initRoot =
+            graph.m_index.find(jobs[j].m_initRoot);
+        NS_ASSERT(root != graph.m_index.end() && initRoot != graph.m_index.end());
+        context.m_neighbor[j] = root->second;
+        context.m_jobsOf[initRoot->second].push_back(j);
+    }
+}
+
+void
+RouteManagerImpl::RunReverseSPFWorker(ReverseSPFContext* context, std::atomic<uint32_t>* next)
+{
+    ReverseSPFState state;
+    uint32_t nRouters = context->m_graph->m_lsas.size();
+    for (uint32_t dest = (*next)++; dest < nRouters; dest = (*next)++)
+    {
+        ReverseSPFDestination(context, dest, state);
+    }
+}
+
+void
+RouteManagerImpl::ReverseSPFDestination(ReverseSPFContext* context,
+                                        uint32_t dest,
+                                        ReverseSPFState& state)
+{
+    NS_LOG_FUNCTION(context << dest);
+    const SPFGraph& graph = *context->m_graph;
+    const std::vector<SPFJob>& jobs = *context->m_jobs;
+    ReverseSPFResult& result = context->m_results[dest];
+    uint32_t nRouters = graph.m_lsas.size();
+
+    //
+    // Distance of every router to the destination, following the links
+    // backwards from the destination.
+    //
+    std::vector<uint32_t>& distance = state.m_distance;
+    distance.assign(nRouters, DISTINFINITY);
+    state.m_order.clear();
+    SPFGraphQueue_t queue;
+    distance[dest] = 0;
+    queue.push(SPFGraphQueueItem_t(0, dest));
+    while (!queue.empty())
+    {
+        SPFGraphQueueItem_t top = queue.top();
+        queue.pop();
+        uint32_t y = top.second;
+        if (top.first != distance[y])
+        {
+            continue;
+        }
+        state.m_order.push_back(y);
+        for (uint32_t k = graph.m_inBegin[y]; k < graph.m_inBegin[y + 1]; k++)
+        {
+            uint32_t x = graph.m_inFrom[k];
+            if (distance[y] + graph.m_inMetric[k] < distance[x])
+            {
+                distance[x] = distance[y] + graph.m_inMetric[k];
+                queue.push(SPFGraphQueueItem_t(distance[x], x));
+            }
+        }
+    }
+
+    //
+    // Dominator tree of the shortest path graph towards the destination:
+    // router u dominates router x if every shortest path from x goes through
+    // u.  Metrics are positive, so the next hops of a router are settled
+    // before it and its immediate dominator is their nearest common
+    // dominator.
+    //
+    std::vector<uint32_t>& idom = state.m_idom;
+    std::vector<uint32_t>& depth = state.m_depth;
+    idom.assign(nRouters, DISTINFINITY);
+    depth.assign(nRouters, 0);
+    idom[dest] = dest;
+    for (uint32_t i = 1; i < state.m_order.size(); i++)
+    {
+        uint32_t x = state.m_order[i];
+        uint32_t dom = DISTINFINITY;
+        for (uint32_t k = graph.m_outBegin[x]; k < graph.m_outBegin[x + 1]; k++)
+        {
+            uint32_t y = graph.m_outTo[k];
+            if (distance[y] == DISTINFINITY || distance[y] + graph.m_outMetric[k] != distance[x])
+            {
+                continue;
+            }
+            if (dom == DISTINFINITY)
+            {
+                dom = y;
+                continue;
+            }
+            while (dom != y)
+            {
+                if (depth[dom] >= depth[y])
+                {
+                    dom = idom[dom];
+                }
+                else
+                {
+                    y = idom[y];
+                }
+            }
+        }
+        NS_ASSERT(dom != DISTINFINITY);
+        idom[x] = dom;
+        depth[x] = depth[dom] + 1;
+    }
+
+    //
+    // Number the dominator tree in preorder, so that the routers a router
+    // dominates are the ones numbered [first, first + size).
+    //
+    std::vector<uint32_t>& size = state.m_size;
+    std::vector<uint32_t>& first = state.m_first;
+    size.assign(nRouters, 1);
+    first.assign(nRouters, DISTINFINITY);
+    state.m_children.resize(nRouters);
+    for (uint32_t i = 0; i < state.m_order.size(); i++)
+    {
+        state.m_children[state.m_order[i]].clear();
+    }
+    for (uint32_t i = state.m_order.size() - 1; i > 0; i--)
+    {
+        uint32_t x = state.m_order[i];
+        size[idom[x]] += size[x];
+        state.m_children[idom[x]].push_back(x);
+    }
+    state.m_preorder.clear();
+    std::vector<uint32_t> stack(1, dest);
+    while (!stack.empty())
+    {
+        uint32_t x = stack.back();
+        stack.pop_back();
+        first[x] = state.m_preorder.size();
+        state.m_preorder.push_back(x);
+        stack.insert(stack.end(), state.m_children[x].begin(), state.m_children[x].end());
+    }
+
+    std::vector<uint32_t>& replacement = state.m_replacement;
+    replacement.resize(nRouters, DISTINFINITY);
+    for (uint32_t u = 0; u < nRouters; u++)
+    {
+        const std::vector<uint32_t>& uJobs = context->m_jobsOf[u];
+        if (uJobs.empty() || u == dest)
+        {
+            continue;
+        }
+        //
+        // Removing router u only changes the distances of the routers it
+        // dominates.  Those are recomputed, on demand, with a Dijkstra
+        // calculation restricted to them, seeded with their links to the
+        // routers u does not dominate.
+        //
+        bool uInTree = (distance[u] != DISTINFINITY);
+        uint32_t subBegin = uInTree ? first[u] : 0;
+        uint32_t subEnd = uInTree ? first[u] + size[u] : 0;
+        bool replaced = false;
+
+        for (uint32_t jj = 0; jj < uJobs.size(); jj++)
         {
-            // std::cout << "i = " << i << std::endl;
-            if (v->GetVertexType() == Vertex::VertexRouter)
+            uint32_t j = uJobs[jj];
+            uint32_t nb = context->m_neighbor[j];
+            if (nb == dest)
             {
-                NS_LOG_LOGIC("Examining link " << i << " of " << v->GetVertexId() << "'s "
-                                               << v->GetLSA()->GetNLinkRecords()
-                                               << " link records");
-                //
-                // (a) If this is a link to a stub network, examine the next link in V's LSA.
-                // Links to stub networks will be considered in the second stage of the
-                // shortest path calculation.
-                //
-                l = v->GetLSA()->GetLinkRecord(i);
-                NS_ASSERT(l != 0);
-                if (l->GetLinkType() == LinkRecord::StubNetwork)
-                {
-                    NS_LOG_LOGIC("Found a Stub record to " << l->GetLinkId());
-                    continue;
-                }
-                //
-                // (b) Otherwise, W is a transit vertex (router or transit network).  Look up
-                // the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
-                // database.
-                //
-                if (l->GetLinkType() == LinkRecord::PointToPoint)
+                // the root of the SPF tree is not one of its destinations
+                continue;
+            }
+            bool nbDominated = (distance[nb] != DISTINFINITY && first[nb] >= subBegin &&
+                                first[nb] < subEnd);
+            if (nbDominated && !replaced)
+            {
+                SPFGraphQueue_t subQueue;
+                for (uint32_t i = subBegin + 1; i < subEnd; i++)
                 {
-                    //
-                    // Lookup the link state advertisement of the new link -- we call it <w> in
-                    // the link state database.
-                    //
-                    w_lsa = m_lsdb->GetLSA(l->GetLinkId());
-                    if (!w_lsa)
+                    uint32_t x = state.m_preorder[i];
+                    replacement[x] = DISTINFINITY;
+                    for (uint32_t k = graph.m_outBegin[x]; k < graph.m_outBegin[x + 1]; k++)
                     {
-                        NS_LOG_ERROR("LSA not found for Linkid");
+                        uint32_t y = graph.m_outTo[k];
+                        if (distance[y] == DISTINFINITY ||
+                            (first[y] >= subBegin && first[y] < subEnd))
+                        {
+                            continue;
+                        }
+                        replacement[x] =
+                            std::min(replacement[x], distance[y] + graph.m_outMetric[k]);
                     }
-                    NS_ASSERT(w_lsa);
-
-                    NS_LOG_LOGIC("Found a P2P record from " << v->GetVertexId() << " to "
-                                                            << w_lsa->GetLinkStateId());
-                    Ptr<Router> router = node->GetObject<Router>();
-                    if (!router)
+                    if (replacement[x] != DISTINFINITY)
+                    {
+                        subQueue.push(SPFGraphQueueItem_t(replacement[x], x));
+                    }
+                }
+                while (!subQueue.empty())
+                {
+                    SPFGraphQueueItem_t top = subQueue.top();
+                    subQueue.pop();
+                    uint32_t x = top.second;
+                    if (top.first != replacement[x])
                     {
                         continue;
                     }
-                    Ptr<GBR> gr = router->GetRoutingProtocol();
-                    NS_ASSERT(gr);
-                    LinkRecord* linkRemote = 0;
-                    Vertex* w = new Vertex(w_lsa);
-                    linkRemote = SPFGetNextLink(w, v, linkRemote);
-                    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-                    int32_t Iface = ipv4->GetInterfaceForAddress(l->GetLinkData());
-                    // std::cout << "The interface = " << Iface << std::endl;
-                    // gr->AddHostRouteTo (linkRemote->GetLinkData (), linkRemote->GetLinkData (),
-                    // Iface, l->GetMetric ());
-
-                    // todo
-                    for (NodeList::Iterator j = NodeList::Begin(); j != listEnd; j++)
+                    for (uint32_t k = graph.m_inBegin[x]; k < graph.m_inBegin[x + 1]; k++)
                     {
-                        Ptr<Node> nextNode = *j;
-                        Ptr<Ipv4> nextIpv4 = nextNode->GetObject<Ipv4>();
-                        for (uint32_t iter = 0; iter < nextIpv4->GetNInterfaces(); iter++)
+                        uint32_t z = graph.m_inFrom[k];
+                        if (z == u || distance[z] == DISTINFINITY || first[z] < subBegin ||
+                            first[z] >= subEnd)
                         {
-                            Ipv4InterfaceAddress ifc = nextIpv4->GetAddress(iter, 0);
-                            Ipv4Address addr = ifc.GetLocal();
-                            if (addr == linkRemote->GetLinkData())
-                            {
-                                for (uint32_t nIfc = 1; nIfc < nextIpv4->GetNInterfaces(); nIfc++)
-                                {
-                                    gr->AddHostRouteTo(nextIpv4->GetAddress(nIfc, 0).GetLocal(),
-                                                       linkRemote->GetLinkData(),
-                                                       Iface,
-                                                       -1,
-                                                       l->GetMetric());
-                                }
-                            }
+                            continue;
+                        }
+                        if (replacement[x] + graph.m_inMetric[k] < replacement[z])
+                        {
+                            replacement[z] = replacement[x] + graph.m_inMetric[k];
+                            subQueue.push(SPFGraphQueueItem_t(replacement[z], z));
                         }
                     }
+                }
+                replaced = true;
+            }
 
-                    SPFCalculate(w_lsa->GetLinkStateId(), rtr->GetRouterId(), linkRemote, Iface);
+            uint32_t d = nbDominated ? replacement[nb] : distance[nb];
+            if (d == DISTINFINITY)
+            {
+                continue;
+            }
+            //
+            // The exit directions are the links of the neighbor that start a
+            // shortest path avoiding u, sorted and unique like the ECMP exits
+            // of a Vertex.  A router u dominates is never on a shortest path
+            // of a router it does not dominate.
+            //
+            state.m_exits.clear();
+            for (uint32_t k = graph.m_outBegin[nb]; k < graph.m_outBegin[nb + 1]; k++)
+            {
+                uint32_t y = graph.m_outTo[k];
+                if (y == u || distance[y] == DISTINFINITY)
+                {
+                    continue;
                 }
-                else if (l->GetLinkType() == LinkRecord::TransitNetwork)
+                uint32_t dy = distance[y];
+                if (first[y] >= subBegin && first[y] < subEnd)
                 {
-                    w_lsa = m_lsdb->GetLSA(l->GetLinkId());
-                    NS_ASSERT(w_lsa);
-                    NS_LOG_LOGIC("Found a Transit record from " << v->GetVertexId() << " to "
-                                                                << w_lsa->GetLinkStateId());
-                    SPFCalculate(w_lsa->GetLinkStateId(), rtr->GetRouterId(), l, i + 1);
+                    if (!nbDominated)
+                    {
+                        continue;
+                    }
+                    dy = replacement[y];
                 }
-                else
+                if (dy != DISTINFINITY && dy + graph.m_outMetric[k] == d)
                 {
-                    NS_ASSERT_MSG(0, "illegal Link Type");
+                    state.m_exits.push_back(
+                        Vertex::NodeExit_t(graph.m_outNextHop[k], graph.m_outIface[k]));
                 }
             }
-        }
-        }
+            NS_ASSERT(!state.m_exits.empty());
+            std::sort(state.m_exits.begin(), state.m_exits.end());
+            state.m_exits.erase(std::unique(state.m_exits.begin(), state.m_exits.end()),
+                                state.m_exits.end());
 
-    NS_LOG_INFO("Finished SPF calculation");
+            //
+            // Same routes as SPFIntraAddRouter () and SPFIntraAddStub () for
+            // the destination vertex of the SPF tree rooted at the neighbor.
+            //
+            const SPFJob& job = jobs[j];
+            for (uint32_t k = graph.m_hostBegin[dest]; k < graph.m_hostBegin[dest + 1]; k++)
+            {
+                RouteRecord route;
+                route.m_type = RouteRecord::HostRoute;
+                route.m_routerId = job.m_initRoot;
+                route.m_dest = graph.m_hosts[k];
+                route.m_mask = Ipv4Mask::GetOnes();
+                route.m_nextHop = job.m_link->GetLinkData();
+                route.m_interface = job.m_iface;
+                route.m_nextInterface = state.m_exits[0].second;
+                route.m_distance = job.m_link->GetMetric() + d;
+                result.m_hostRoutes.push_back(std::make_pair(j, route));
+            }
+            for (uint32_t k = graph.m_stubBegin[dest]; k < graph.m_stubBegin[dest + 1]; k++)
+            {
+                for (uint32_t e = 0; e < state.m_exits.size(); e++)
+                {
+                    if (state.m_exits[e].second < 0)
+                    {
+                        continue;
+                    }
+                    RouteRecord route;
+                    route.m_type = RouteRecord::NetworkRoute;
+                    route.m_routerId = job.m_root;
+                    route.m_dest = graph.m_stubNetworks[k];
+                    route.m_mask = graph.m_stubMasks[k];
+                    route.m_nextHop = state.m_exits[e].first;
+                    route.m_interface = state.m_exits[e].second;
+                    route.m_nextInterface = DISTINFINITY;
+                    route.m_distance = DISTINFINITY;
+                    result.m_networkRoutes.push_back(std::make_pair(j, route));
+                }
+            }
+        }
+    }
 }
 
 //
@@ -958,7 +2785,7 @@ RouteManagerImpl::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
         // If the link is to a router that is already in the shortest path first tree
         // then we have it covered -- ignore it.
         //
-        if (w_lsa->GetStatus() == LSA::LSA_SPF_IN_SPFTREE)
+        if (GetSPFStatus(w_lsa) == LSA::LSA_SPF_IN_SPFTREE)
         {
             NS_LOG_LOGIC("Skipping ->  LSA " << w_lsa->GetLinkStateId() << " already in SPF tree");
             continue;
@@ -982,7 +2809,7 @@ RouteManagerImpl::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
         NS_LOG_LOGIC("Considering w_lsa " << w_lsa->GetLinkStateId());
 
         // Is there already vertex w in candidate list?
-        if (w_lsa->GetStatus() == LSA::LSA_SPF_NOT_EXPLORED)
+        if (GetSPFStatus(w_lsa) == LSA::LSA_SPF_NOT_EXPLORED)
         {
             // Calculate nexthop to w
             // We need to figure out how to actually get to the new router represented
@@ -991,10 +2818,10 @@ RouteManagerImpl::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
             // used to forward the packets.
 
             // prepare vertex w
-            w = new Vertex(w_lsa);
+            w = m_vertexArena.Allocate(w_lsa);
             if (SPFNexthopCalculation(v, w, l, distance))
             {
-                w_lsa->SetStatus(LSA::LSA_SPF_CANDIDATE);
+                SetSPFStatus(w_lsa, LSA::LSA_SPF_CANDIDATE);
                 //
                 // Push this new vertex onto the priority queue (ordered by distance from the
                 // root node).
@@ -1008,7 +2835,7 @@ RouteManagerImpl::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
                 NS_ASSERT_MSG(0,
                               "SPFNexthopCalculation never " << "return false, but it does now!");
         }
-        else if (w_lsa->GetStatus() == LSA::LSA_SPF_CANDIDATE)
+        else if (GetSPFStatus(w_lsa) == LSA::LSA_SPF_CANDIDATE)
         {
             //
             // We have already considered the link represented by <w>.  What wse have to
@@ -1053,16 +2880,12 @@ RouteManagerImpl::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
                 // (ospf_spf.c::859), although the detail implementation
                 // is very different from quagga (blame ns3::RouteManagerImpl)
 
-                // prepare vertex w
-                w = new Vertex(w_lsa);
+                // prepare vertex w; it is never linked into the tree, so
+                // the arena simply reclaims it with the others
+                w = m_vertexArena.Allocate(w_lsa);
                 SPFNexthopCalculation(v, w, l, distance);
                 cw->MergeRootExitDirections(w);
                 cw->MergeParent(w);
-                // VertexAddParent (w) is necessary as the destructor of
-                // Vertex checks if the vertex and its parent is linked
-                // bidirectionally
-                VertexAddParent(w);
-                delete w;
             }
             else // cw->GetDistanceFromRoot () > w->GetDistanceFromRoot ()
             {
@@ -1080,7 +2903,7 @@ RouteManagerImpl::SPFNext(Vertex* v, RouteCandidateQueue& candidate)
                     // If we've changed the cost to get to the vertex represented by <w>, we
                     // must reorder the priority queue keyed to that cost.
                     //
-                    candidate.Reorder();
+                    candidate.DecreaseKey(cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -1430,18 +3253,16 @@ RouteManagerImpl::CheckForStubNode(Ipv4Address root)
                 if (lr->GetLinkId() == myRouterId)
                 {
                     // Next hop is stored in the LinkID field of lr
-                    Ptr<Router> router = rlsa->GetNode()->GetObject<Router>();
-                    NS_ASSERT(router);
-                    Ptr<GBR> gr = router->GetRoutingProtocol();
-                    NS_ASSERT(gr);
-                    gr->AddNetworkRouteTo(Ipv4Address("0.0.0.0"),
-                                          Ipv4Mask("0.0.0.0"),
-                                          lr->GetLinkData(),
-                                          FindOutgoingInterfaceId(transitLink->GetLinkData()));
+                    AddRouteRecord(RouteRecord::NetworkRoute,
+                                   myRouterId,
+                                   Ipv4Address("0.0.0.0"),
+                                   Ipv4Mask("0.0.0.0"),
+                                   lr->GetLinkData(),
+                                   FindRouterInterfaceId(myRouterId, transitLink->GetLinkData()));
                     NS_LOG_LOGIC("Inserting default route for node "
                                  << myRouterId << " to next hop " << lr->GetLinkData()
                                  << " via interface "
-                                 << FindOutgoingInterfaceId(transitLink->GetLinkData()));
+                                 << FindRouterInterfaceId(myRouterId, transitLink->GetLinkData()));
                     return true;
                 }
             }
@@ -1461,37 +3282,45 @@ RouteManagerImpl::SPFCalculate(Ipv4Address root,
     // std::cout << "The interface = " << Iface << std::endl;
     Vertex* v;
     //
-    // Initialize the Link State Database.
+    // Initialize the SPF status of the Link State Database.  The status is
+    // kept here rather than in the LSAs, which are shared with the other
+    // calculations, and is reset by starting a new epoch instead of walking
+    // the database.
     //
-    m_lsdb->Initialize();
+    ResetSPFStatus();
     //
     // The candidate queue is a priority queue of Vertex objects, with the top
     // of the queue being the closest vertex in terms of distance from the root
     // of the tree.  Initially, this queue is empty.
     //
-    RouteCandidateQueue candidate;
+    RouteCandidateQueue& candidate = m_candidate;
+    candidate.Clear();
     NS_ASSERT(candidate.Size() == 0);
     //
+    // The vertices of the previous calculation are recycled.
+    //
+    m_vertexArena.Reset();
+    //
     // Initialize the shortest-path tree to only contain the router doing the
     // calculation.  Each router (and corresponding network) is a vertex in the
     // shortest path first (SPF) tree.
     //
-    v = new Vertex(m_lsdb->GetLSA(root));
+    v = m_vertexArena.Allocate(m_lsdb->GetLSA(root));
 
     /**
      * @brief add the initroot for SPF
      * \author Pu Yang
      */
     Vertex* v_init;
-    v_init = new Vertex(m_lsdb->GetLSA(initroot));
-    v_init->GetLSA()->SetStatus(LSA::LSA_SPF_IN_SPFTREE);
+    v_init = m_vertexArena.Allocate(m_lsdb->GetLSA(initroot));
+    SetSPFStatus(v_init->GetLSA(), LSA::LSA_SPF_IN_SPFTREE);
     //
     // This vertex is the root of the SPF tree and it is distance 0 from the root.
     // We also mark this vertex as being in the SPF tree.
     //
     m_spfroot = v;
     v->SetDistanceFromRoot(l->GetMetric());
-    v->GetLSA()->SetStatus(LSA::LSA_SPF_IN_SPFTREE);
+    SetSPFStatus(v->GetLSA(), LSA::LSA_SPF_IN_SPFTREE);
     NS_LOG_LOGIC("Starting SPFCalculate for node " << root);
 
     //
@@ -1501,10 +3330,10 @@ RouteManagerImpl::SPFCalculate(Ipv4Address root,
     // reached.  Instead, short-circuit this computation and just install
     // a default route in the CheckForStubNode() method.
     //
-    if (NodeList::GetNNodes() > 0 && CheckForStubNode(root))
+    if (m_manager->m_nNodes > 0 && CheckForStubNode(root))
     {
         NS_LOG_LOGIC("SPFCalculate truncated for stub node " << root);
-        delete m_spfroot;
+        m_spfroot = 0;
         return;
     }
 
@@ -1552,7 +3381,7 @@ RouteManagerImpl::SPFCalculate(Ipv4Address root,
         // Update the status field of the vertex to indicate that it is in the SPF
         // tree.
         //
-        v->GetLSA()->SetStatus(LSA::LSA_SPF_IN_SPFTREE);
+        SetSPFStatus(v->GetLSA(), LSA::LSA_SPF_IN_SPFTREE);
         //
         // The current vertex has a parent pointer.  By calling this rather oddly
         // named method (blame quagga) we add the current vertex to the list of
@@ -1621,10 +3450,9 @@ RouteManagerImpl::SPFCalculate(Ipv4Address root,
 
     //
     // We're all done setting the routing information for the node at the root of
-    // the SPF tree.  Delete all of the vertices and corresponding resources.  Go
+    // the SPF tree.  The vertices stay in the arena, which recycles them when we
     // possibly do it again for the next router.
     //
-    delete m_spfroot;
     m_spfroot = 0;
 }
 
@@ -1678,116 +3506,48 @@ RouteManagerImpl::SPFAddASExternal(LSA* extlsa, Vertex* v)
     NS_LOG_LOGIC("External is on remote host: " << extlsa->GetAdvertisingRouter()
                                                 << "; installing");
 
+    //
+    // The router corresponding to the root vertex is the one we're going to
+    // write the routing information to.
+    //
     Ipv4Address routerId = m_spfroot->GetVertexId();
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
-    //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
-    //
-    NodeList::Iterator i = NodeList::Begin();
-    NodeList::Iterator listEnd = NodeList::End();
-    for (; i != listEnd; i++)
+    NS_ASSERT_MSG(v->GetLSA(),
+                  "RouteManagerImpl::SPFAddASExternal (): "
+                  "Expected valid LSA in Vertex* v");
+    Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask();
+    Ipv4Address tempip = extlsa->GetLinkStateId();
+    tempip = tempip.CombineMask(tempmask);
+
+    // walk through all next-hop-IPs and out-going-interfaces for reaching
+    // the stub network gateway 'v' from the root node
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the Router interface, so we need
-        // to QI for that interface.  If there's no Router interface, the node
-        // in question cannot be the router we want, so we continue.
-        //
-        Ptr<Router> rtr = node->GetObject<Router>();
-
-        if (!rtr)
+        Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
+        if (outIf >= 0)
         {
-            NS_LOG_LOGIC("No Router interface on node " << node->GetId());
-            continue;
+            AddRouteRecord(RouteRecord::ASExternalRoute,
+                           routerId,
+                           tempip,
+                           tempmask,
+                           nextHop,
+                           outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                   << " add external network route to " << tempip
+                                   << " using next hop " << nextHop << " via interface "
+                                   << outIf);
         }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        else
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to QI
-            // for that interface.  If the node is acting as an IP version 4 router, it
-            // should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "RouteManagerImpl::SPFIntraAddRouter (): "
-                          "QI for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            NS_ASSERT_MSG(v->GetLSA(),
-                          "RouteManagerImpl::SPFIntraAddRouter (): "
-                          "Expected valid LSA in Vertex* v");
-            Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask();
-            Ipv4Address tempip = extlsa->GetLinkStateId();
-            tempip = tempip.CombineMask(tempmask);
-
-            //
-            // Here's why we did all of that work.  We're going to add a host route to the
-            // host address found in the m_linkData field of the point-to-point link
-            // record.  In the case of a point-to-point link, this is the local IP address
-            // of the node connected to the link.  Each of these point-to-point links
-            // will correspond to a local interface that has an IP address to which
-            // the node at the root of the SPF tree can send packets.  The vertex <v>
-            // (corresponding to the node that has these links and interfaces) has
-            // an m_nextHop address precalculated for us that is the address to which the
-            // root node should send packets to be forwarded to these IP addresses.
-            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-            // which the packets should be send for forwarding.
-            //
-            Ptr<Router> router = node->GetObject<Router>();
-            if (!router)
-            {
-                continue;
-            }
-            Ptr<GBR> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all next-hop-IPs and out-going-interfaces for reaching
-            // the stub network gateway 'v' from the root node
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-                /**
-                 * \author Pu Yang
-                 * \brief get the distance
-                 */
-                // uint32_t distance = v->GetDistanceFromRoot ();
-                // std::cout << "the SPF distance = " << distance;
-
-                if (outIf >= 0)
-                {
-                    gr->AddASExternalRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add external network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative");
-                }
-            }
-            return;
-        } // if
-    } // for
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative");
+        }
+    }
 }
 
 // Processing logic from RFC 2328, page 166 and quagga ospf_spf_process_stubs ()
@@ -1847,113 +3607,44 @@ RouteManagerImpl::SPFIntraAddStub(LinkRecord* l, Vertex* v)
     //
     // The root of the Shortest Path First tree is the router to which we are
     // going to write the actual routing table entries.  The vertex corresponding
-    // to this router has a vertex ID which is the router ID of that node.  We're
-    // going to use this ID to discover which node it is that we're actually going
-    // to update.
+    // to this router has a vertex ID which is the router ID of that node.
     //
     Ipv4Address routerId = m_spfroot->GetVertexId();
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
+    NS_ASSERT_MSG(v->GetLSA(),
+                  "RouteManagerImpl::SPFIntraAddStub (): "
+                  "Expected valid LSA in Vertex* v");
+    Ipv4Mask tempmask(l->GetLinkData().Get());
+    Ipv4Address tempip = l->GetLinkId();
+    tempip = tempip.CombineMask(tempmask);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // The vertex <v> (corresponding to the node that has the stub network) has
+    // the next hop addresses and outbound interfaces precalculated for us that
+    // the root node should use to forward packets to the stub network.
     //
-    NodeList::Iterator i = NodeList::Begin();
-    NodeList::Iterator listEnd = NodeList::End();
-    for (; i != listEnd; i++)
+    // walk through all next-hop-IPs and out-going-interfaces for reaching
+    // the stub network gateway 'v' from the root node
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the Router interface, so we need
-        // to QI for that interface.  If there's no Router interface, the node
-        // in question cannot be the router we want, so we continue.
-        //
-        Ptr<Router> rtr = node->GetObject<Router>();
-
-        if (!rtr)
+        Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
+        if (outIf >= 0)
         {
-            NS_LOG_LOGIC("No Router interface on node " << node->GetId());
-            continue;
+            AddRouteRecord(RouteRecord::NetworkRoute, routerId, tempip, tempmask, nextHop, outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId << " add network route to "
+                                   << tempip << " using next hop " << nextHop
+                                   << " via interface " << outIf);
         }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        else
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to QI
-            // for that interface.  If the node is acting as an IP version 4 router, it
-            // should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "RouteManagerImpl::SPFIntraAddRouter (): "
-                          "QI for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            NS_ASSERT_MSG(v->GetLSA(),
-                          "RouteManagerImpl::SPFIntraAddRouter (): "
-                          "Expected valid LSA in Vertex* v");
-            Ipv4Mask tempmask(l->GetLinkData().Get());
-            Ipv4Address tempip = l->GetLinkId();
-            tempip = tempip.CombineMask(tempmask);
-            //
-            // Here's why we did all of that work.  We're going to add a host route to the
-            // host address found in the m_linkData field of the point-to-point link
-            // record.  In the case of a point-to-point link, this is the local IP address
-            // of the node connected to the link.  Each of these point-to-point links
-            // will correspond to a local interface that has an IP address to which
-            // the node at the root of the SPF tree can send packets.  The vertex <v>
-            // (corresponding to the node that has these links and interfaces) has
-            // an m_nextHop address precalculated for us that is the address to which the
-            // root node should send packets to be forwarded to these IP addresses.
-            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-            // which the packets should be send for forwarding.
-            //
-
-            Ptr<Router> router = node->GetObject<Router>();
-            if (!router)
-            {
-                continue;
-            }
-            Ptr<GBR> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all next-hop-IPs and out-going-interfaces for reaching
-            // the stub network gateway 'v' from the root node
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-                if (outIf >= 0)
-                {
-                    gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative");
-                }
-            }
-            return;
-        } // if
-    } // for
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
@@ -1970,66 +3661,41 @@ RouteManagerImpl::FindOutgoingInterfaceId(Ipv4Address a, Ipv4Mask amask)
     //
     // We have an IP address <a> and a vertex ID of the root of the SPF tree.
     // The question is what interface index does this address correspond to.
-    // The answer is a little complicated since we have to find a pointer to
-    // the node corresponding to the vertex ID, find the Ipv4 interface on that
-    // node in order to iterate the interfaces and find the one corresponding to
-    // the address in question.
     //
-    Ipv4Address routerId = m_spfroot->GetVertexId();
+    return FindRouterInterfaceId(m_spfroot->GetVertexId(), a, amask);
+}
+
+int32_t
+RouteManagerImpl::FindRouterInterfaceId(Ipv4Address routerId, Ipv4Address a, Ipv4Mask amask) const
+{
+    NS_LOG_FUNCTION(this << routerId << a << amask);
     //
-    // Walk the list of nodes in the system looking for the one corresponding to
-    // the node at the root of the SPF tree.  This is the node for which we are
-    // building the routing table.
+    // The addresses of the node corresponding to the router ID were captured
+    // by BuildIndexes (), in the order Ipv4::GetInterfaceForPrefix ()
+    // would walk them.
     //
-    NodeList::Iterator i = NodeList::Begin();
-    NodeList::Iterator listEnd = NodeList::End();
-    for (; i != listEnd; i++)
+    RouterInfos_t::const_iterator i = m_manager->m_routers.find(routerId);
+    if (i == m_manager->m_routers.end())
     {
-        Ptr<Node> node = *i;
-
-        Ptr<Router> rtr = node->GetObject<Router>();
         //
-        // If the node doesn't have a Router interface it can't be the one
-        // we're interested in.
+        // Couldn't find it.
         //
-        if (!rtr)
-        {
-            continue;
-        }
-
-        if (rtr->GetRouterId() == routerId)
-        {
-            //
-            // This is the node we're building the routing table for.  We're going to need
-            // the Ipv4 interface to look for the ipv4 interface index.  Since this node
-            // is participating in routing IP version 4 packets, it certainly must have
-            // an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "RouteManagerImpl::FindOutgoingInterfaceId (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Look through the interfaces on this node for one that has the IP address
-            // we're looking for.  If we find one, return the corresponding interface
-            // index, or -1 if not found.
-            //
-            int32_t interface = ipv4->GetInterfaceForPrefix(a, amask);
-
-#if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("RouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif
-            return interface;
-        }
+        NS_LOG_LOGIC("FindRouterInterfaceId():Can't find router " << routerId);
+        return -1;
     }
     //
-    // Couldn't find it.
+    // Look through the interfaces on this node for one that has the IP address
+    // we're looking for.  If we find one, return the corresponding interface
+    // index, or -1 if not found.
     //
-    NS_LOG_LOGIC("FindOutgoingInterfaceId():Can't find root node " << routerId);
+    const std::vector<std::pair<int32_t, Ipv4Address>>& addresses = i->second.m_addresses;
+    for (uint32_t j = 0; j < addresses.size(); j++)
+    {
+        if (addresses[j].second.CombineMask(amask) == a.CombineMask(amask))
+        {
+            return addresses[j].first;
+        }
+    }
     return -1;
 }
 
@@ -2055,117 +3721,59 @@ RouteManagerImpl::SPFIntraAddRouter(Vertex* v, Vertex* v_init, Ipv4Address nextH
     NS_LOG_FUNCTION(this << v);
 
     NS_ASSERT_MSG(m_spfroot, "RouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
-    //
-    // The root of the Shortest Path First tree is the router to which we are
-    // going to write the actual routing table entries.  The vertex corresponding
-    // to this router has a vertex ID which is the router ID of that node.  We're
-    // going to use this ID to discover which node it is that we're actually going
-    // to update.
-    //
-    Ipv4Address routerId = m_spfroot->GetVertexId();
 
     /**
      * @brief the router Ipv4 Address to write the routing table
      * \author Pu Yang
      */
     Ipv4Address routerId_init = v_init->GetVertexId();
-    NS_LOG_LOGIC("Vertex ID = " << routerId);
+    NS_LOG_LOGIC("Vertex ID = " << m_spfroot->GetVertexId());
 
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Get the Global Router Link State Advertisement from the vertex we're
+    // adding the routes to.  The LSA will have a number of attached Global Router
+    // Link Records corresponding to links off of that vertex / node.  We're going
+    // to be interested in the records corresponding to point-to-point links.
     //
+    LSA* lsa = v->GetLSA();
+    NS_ASSERT_MSG(lsa,
+                  "RouteManagerImpl::SPFIntraAddRouter (): "
+                  "Expected valid LSA in Vertex* v");
 
-    NodeList::Iterator listEnd = NodeList::End();
-    NodeList::Iterator i = NodeList::Begin();
-
-    for (; i != listEnd; i++)
+    uint32_t nLinkRecords = lsa->GetNLinkRecords();
+    //
+    // Iterate through the link records on the vertex to which we're going to add
+    // routes.  To make sure we're being clear, we're going to add routing table
+    // entries to the tables on the node corresping to the initial root.
+    // These entries will have routes to the IP addresses we find from looking at
+    // the local side of the point-to-point links found on the node described by
+    // the vertex <v>.
+    //
+    NS_LOG_LOGIC(" Router " << routerId_init << " found " << nLinkRecords
+                            << " link records in LSA " << lsa << "with LinkStateId "
+                            << lsa->GetLinkStateId());
+    for (uint32_t j = 0; j < nLinkRecords; ++j)
     {
-        Ptr<Node> node = *i;
         //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to GetObject for that interface.  If there's no GlobalRouter interface,
-        // the node in question cannot be the router we want, so we continue.
+        // We are only concerned about point-to-point links
         //
-        Ptr<Router> rtr = node->GetObject<Router>();
-
-        if (!rtr)
+        LinkRecord* lr = lsa->GetLinkRecord(j);
+        if (lr->GetLinkType() != LinkRecord::PointToPoint)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
             continue;
         }
-        // std::cout << "The neighbour node " << node->GetId () << std::endl;
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId_init)
+        uint32_t distance = v->GetDistanceFromRoot();
+        if (v->GetNRootExitDirections() >= 1)
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to
-            // GetObject for that interface.  If the node is acting as an IP version 4
-            // router, it should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "RouteManagerImpl::SPFIntraAddRouter (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            LSA* lsa = v->GetLSA();
-            NS_ASSERT_MSG(lsa,
-                          "RouteManagerImpl::SPFIntraAddRouter (): "
-                          "Expected valid LSA in Vertex* v");
-
-            uint32_t nLinkRecords = lsa->GetNLinkRecords();
-            //
-            // Iterate through the link records on the vertex to which we're going to add
-            // routes.  To make sure we're being clear, we're going to add routing table
-            // entries to the tables on the node corresping to the root of the SPF tree.
-            // These entries will have routes to the IP addresses we find from looking at
-            // the local side of the point-to-point links found on the node described by
-            // the vertex <v>.
-            //
-            NS_LOG_LOGIC(" Node " << node->GetId() << " found " << nLinkRecords
-                                  << " link records in LSA " << lsa << "with LinkStateId "
-                                  << lsa->GetLinkStateId());
-            for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
-                //
-                // We are only concerned about point-to-point links
-                //
-                LinkRecord* lr = lsa->GetLinkRecord(j);
-                if (lr->GetLinkType() != LinkRecord::PointToPoint)
-                {
-                    continue;
-                }
-                Ptr<Router> router = node->GetObject<Router>();
-                if (!router)
-                {
-                    continue;
-                }
-                Ptr<GBR> gr = router->GetRoutingProtocol();
-                NS_ASSERT(gr);
-                uint32_t distance = v->GetDistanceFromRoot();
-                if (v->GetNRootExitDirections() >= 1)
-                {
-                    int32_t nextIface = v->GetRootExitDirection(0).second;
-                    gr->AddHostRouteTo(lr->GetLinkData(), nextHop, Iface, nextIface, distance);
-                }
-            }
-            //
-            // Done adding the routes for the selected node.
-            //
-            return;
+            int32_t nextIface = v->GetRootExitDirection(0).second;
+            AddRouteRecord(RouteRecord::HostRoute,
+                           routerId_init,
+                           lr->GetLinkData(),
+                           Ipv4Mask::GetOnes(),
+                           nextHop,
+                           Iface,
+                           nextIface,
+                           distance);
         }
     }
 }
@@ -2179,99 +3787,40 @@ RouteManagerImpl::SPFIntraAddTransit(Vertex* v)
     //
     // The root of the Shortest Path First tree is the router to which we are
     // going to write the actual routing table entries.  The vertex corresponding
-    // to this router has a vertex ID which is the router ID of that node.  We're
-    // going to use this ID to discover which node it is that we're actually going
-    // to update.
+    // to this router has a vertex ID which is the router ID of that node.
     //
     Ipv4Address routerId = m_spfroot->GetVertexId();
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
-    //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
-    //
-    NodeList::Iterator i = NodeList::Begin();
-    NodeList::Iterator listEnd = NodeList::End();
-    for (; i != listEnd; i++)
+    LSA* lsa = v->GetLSA();
+    NS_ASSERT_MSG(lsa,
+                  "RouteManagerImpl::SPFIntraAddTransit (): "
+                  "Expected valid LSA in Vertex* v");
+    Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask();
+    Ipv4Address tempip = lsa->GetLinkStateId();
+    tempip = tempip.CombineMask(tempmask);
+    // walk through all available exit directions due to ECMP,
+    // and add host route for each of the exit direction toward
+    // the vertex 'v'
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the Router interface, so we need
-        // to GetObject for that interface.  If there's no Router interface,
-        // the node in question cannot be the router we want, so we continue.
-        //
-        Ptr<Router> rtr = node->GetObject<Router>();
+        Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
 
-        if (!rtr)
+        if (outIf >= 0)
         {
-            NS_LOG_LOGIC("No Router interface on node " << node->GetId());
-            continue;
+            AddRouteRecord(RouteRecord::NetworkRoute, routerId, tempip, tempmask, nextHop, outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId << " add network route to "
+                                   << tempip << " using next hop " << nextHop
+                                   << " via interface " << outIf);
         }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        else
         {
-            NS_LOG_LOGIC("setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to
-            // GetObject for that interface.  If the node is acting as an IP version 4
-            // router, it should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "RouteManagerImpl::SPFIntraAddTransit (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            LSA* lsa = v->GetLSA();
-            NS_ASSERT_MSG(lsa,
-                          "RouteManagerImpl::SPFIntraAddTransit (): "
-                          "Expected valid LSA in Vertex* v");
-            Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask();
-            Ipv4Address tempip = lsa->GetLinkStateId();
-            tempip = tempip.CombineMask(tempmask);
-            Ptr<Router> router = node->GetObject<Router>();
-            if (!router)
-            {
-                continue;
-            }
-            Ptr<GBR> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all available exit directions due to ECMP,
-            // and add host route for each of the exit direction toward
-            // the vertex 'v'
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                Vertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-
-                if (outIf >= 0)
-                {
-                    gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative " << outIf);
-                }
-            }
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative " << outIf);
         }
     }
 }
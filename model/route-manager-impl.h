@@ -22,17 +22,23 @@
 #ifndef DGR_ROUTE_MANAGER_IMPL_H
 #define DGR_ROUTE_MANAGER_IMPL_H
 
+#include "host-route-index.h"
 #include "route-candidate-queue.h"
 #include "router-interface.h"
 
+#include "ns3/event-id.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <queue>
 #include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace ns3
@@ -121,12 +127,26 @@ class Vertex
     /**
      * @brief Destroy an Vertex (Shortest Path First Vertex).
      *
-     * The children vertices of the Vertex are recursively deleted.
+     * The children vertices are not deleted: the vertices of an SPF
+     * calculation are owned by the VertexArena they were allocated from.
      *
      * @see Vertex::Vertex ()
+     * @see VertexArena
      */
     ~Vertex();
 
+    /**
+     * @brief Reinitialize a Vertex as if it had been constructed from the
+     * given LSA.
+     *
+     * The parent, child and root exit lists are emptied but keep their
+     * storage, so a recycled Vertex usually does not allocate.
+     *
+     * @see Vertex::Vertex (LSA*)
+     * @param lsa The Link State Advertisement used for finding initial values.
+     */
+    void Reset(LSA* lsa);
+
     /**
      * @brief Get the Vertex Type field of a Vertex object.
      *
@@ -538,9 +558,9 @@ class Vertex
     uint32_t m_distanceFromRoot;                    //!< Distance from root node
     int32_t m_rootOif;                              //!< root Output Interface
     Ipv4Address m_nextHop;                          //!< next hop
-    typedef std::list<NodeExit_t> ListOfNodeExit_t; //!< container of Exit nodes
+    typedef std::vector<NodeExit_t> ListOfNodeExit_t; //!< container of Exit nodes
     ListOfNodeExit_t m_ecmpRootExits; //!< store the multiple root's exits for supporting ECMP
-    typedef std::list<Vertex*> ListOfVertex_t; //!< container of Vertexes
+    typedef std::vector<Vertex*> ListOfVertex_t; //!< container of Vertexes
     ListOfVertex_t m_parents;                  //!< parent list
     ListOfVertex_t m_children;                 //!< Children list
     bool m_vertexProcessed; //!< Flag to note whether vertex has been processed in stage two of SPF
@@ -571,6 +591,60 @@ class Vertex
     friend std::ostream& operator<<(std::ostream& os, const Vertex::ListOfVertex_t& vs);
 };
 
+/**
+ * @brief Bump allocator for the vertices of an SPF calculation.
+ *
+ * Vertices are handed out from fixed size chunks that are kept across
+ * calculations.  Reset () makes every vertex available again without freeing
+ * anything, so once the arena has grown to the size of the largest tree an SPF
+ * calculation does not allocate vertices from the heap.  The vertices, and the
+ * trees linking them, are only valid until the next Reset ().
+ */
+class VertexArena
+{
+  public:
+    /**
+     * @brief Create an empty arena.
+     */
+    VertexArena();
+
+    /**
+     * @brief Destroy the arena and every vertex it holds.
+     */
+    ~VertexArena();
+
+    /**
+     * @brief Get a vertex initialized from the given LSA.
+     *
+     * @see Vertex::Reset ()
+     * @param lsa The Link State Advertisement used for finding initial values.
+     * @returns A vertex owned by the arena.
+     */
+    Vertex* Allocate(LSA* lsa);
+
+    /**
+     * @brief Release every vertex handed out since the last Reset ().
+     */
+    void Reset(void);
+
+  private:
+    /**
+     * @brief The VertexArena copy construction is disallowed.
+     * @param arena object to copy from
+     */
+    VertexArena(VertexArena& arena);
+
+    /**
+     * @brief The VertexArena copy assignment operator is disallowed.
+     * @param arena object to copy from
+     * @returns the copied object
+     */
+    VertexArena& operator=(VertexArena& arena);
+
+    std::vector<Vertex*> m_chunks; //!< arrays of VERTEX_ARENA_CHUNK vertices
+    uint32_t m_next;               //!< index of the next vertex to hand out
+};
+
 /**
  * @brief The Link State DataBase (LSDB) of the DGR Route Manager.
  *
@@ -609,7 +683,8 @@ class RouteManagerLSDB
      * State Database.
      *
      * The IPV4 address and the LSA given as parameters are converted
-     * to an STL pair and are inserted into the database map.
+     * to an STL pair and are inserted into the database map, and the LSA is
+     * given the next index.
      *
      * @see LSA
      * @see Ipv4Address
@@ -649,17 +724,22 @@ class RouteManagerLSDB
     LSA* GetLSAByLinkData(Ipv4Address addr) const;
 
     /**
-     * @brief Set all LSA flags to an initialized state, for SPF computation
+     * @brief Get all the Link State Advertisements but the external ones.
      *
-     * This function walks the database and resets the status flags of all of the
-     * contained Link State Advertisements to LSA_SPF_NOT_EXPLORED.  This is done
-     * prior to each SPF calculation to reset the state of the Vertex structures
-     * that will reference the LSAs during the calculation.
+     * @returns the Link State Advertisements, in link state ID order
+     */
+    std::vector<LSA*> GetLSAs() const;
+
+    /**
+     * @brief Get the number of Link State Advertisements but the external ones.
      *
-     * @see LSA
-     * @see Vertex
+     * The LSAs are numbered from 0 to this number minus one in the order they
+     * were inserted.
+     *
+     * @see LSA::GetIndex ()
+     * @returns the number of Link State Advertisements.
      */
-    void Initialize();
+    uint32_t GetNLSAs() const;
 
     /**
      * @brief Look up the External Link State Advertisement associated with the given
@@ -720,6 +800,15 @@ class RouteManagerLSDB
 class RouteManagerImpl
 {
   public:
+    /**
+     * @brief Algorithms computing the routing tables in InitializeRoutes ()
+     */
+    enum RouteEngine
+    {
+        SPF_ENGINE,        /**< one SPF calculation per (router, neighbor) pair */
+        REVERSE_SPF_ENGINE /**< one reverse SPF calculation per destination router */
+    };
+
     RouteManagerImpl();
     virtual ~RouteManagerImpl();
     /**
@@ -734,15 +823,129 @@ class RouteManagerImpl
     /**
      * @brief Build the routing database by gathering Link State Advertisements
      * from each node exporting a Router interface.
+     *
+     * The database is then compiled into the graph the SPF calculations run
+     * on, unless it has other links than point-to-point and stub links, zero
+     * metrics, or external LSAs.
      */
     virtual void BuildRoutingDatabase();
 
     /**
      * @brief Compute routes using a Dijkstra SPF computation and populate
      * per-node forwarding tables
+     *
+     * The SPF calculations run on the number of threads given by the
+     * GBRSpfThreads global value.  The routes, and the order in which they
+     * are installed, are the same whatever the number of threads.
+     *
+     * The GBRRouteEngine global value selects the algorithm.  The reverse
+     * SPF engine installs the same routes as the per-neighbor SPF
+     * calculations; only the order of the routes of a calculation differs,
+     * not the order of the candidate routes to a destination.  It falls back
+     * to the per-neighbor SPF calculations unless every link is a
+     * point-to-point or stub link with a non-zero metric and there is no
+     * external LSA.
      */
     virtual void InitializeRoutes();
 
+    /**
+     * @brief Rebuild the routing database and update the routes after a
+     * change of the topology.
+     *
+     * Only the SPF calculations that read an LSA or an address that changed
+     * are run again, with the per-neighbor SPF engine, and only the routing
+     * tables they add routes to are reinstalled.  The tables are the same as
+     * after DeleteRoutes (), BuildRoutingDatabase () and InitializeRoutes (),
+     * which this falls back to when routers were added or removed, when the
+     * LSDB holds network or external LSAs, or when the routes were computed
+     * by the reverse SPF engine or lazily.
+     */
+    virtual void UpdateRoutes();
+
+    /**
+     * @brief Compute and install the routes to the router owning an address,
+     * if they have not been yet.
+     *
+     * When the GBRLazyRoutes global value is set, InitializeRoutes () only
+     * installs the routes to the neighbors and the default routes of the stub
+     * nodes, and GBR calls this the first time a lookup finds no route to a
+     * destination.  A single reverse SPF calculation rooted at the router
+     * owning the destination then gives the routes of every router towards
+     * it, the same as the other engines install; the routes of a lazy table
+     * are in the order the destinations were resolved.  The lazy routes
+     * fall back to computing every route when the topology is not supported
+     * by the reverse SPF engine, and are dropped by DeleteRoutes () and
+     * UpdateRoutes ().
+     *
+     * @param dest the destination address
+     * @returns true if routes were installed, false if the address is not
+     * owned by a router, its routes were already computed, or the tables are
+     * not lazy
+     */
+    bool ResolveRoutesTo(Ipv4Address dest);
+
+    /**
+     * @returns the number of destination routers whose routes were computed
+     * by ResolveRoutesTo ()
+     */
+    uint32_t GetNResolved() const;
+
+    /**
+     * @brief Write the routes computed by InitializeRoutes () or
+     * UpdateRoutes () to a snapshot file.
+     *
+     * The file is a header (magic, format version, topology hash, number of
+     * routes) followed by fixed-size little-endian route records, in the
+     * order they were installed, so it can be read in one block or memory
+     * mapped.  The routes are saved as computed, before the compression of
+     * the host routes, which LoadRoutingTables () applies again.
+     *
+     * @param path the file to write
+     * @returns true if the routes were written, false if there are no
+     * computed routes to save (lazy routes, or routes loaded from a
+     * snapshot) or the file cannot be written
+     */
+    bool SaveRoutingTables(std::string path) const;
+
+    /**
+     * @brief Install the routes of a snapshot file instead of running the
+     * SPF calculations.
+     *
+     * Called after BuildRoutingDatabase (), in place of InitializeRoutes ().
+     * The snapshot is only used when its topology hash matches the one of
+     * the routing database, i.e. the LSDB and the addresses of the routers
+     * it was saved from are the same; the tables are then the same as
+     * InitializeRoutes () builds with the GBRLazyRoutes global value unset.
+     * The loaded routes are not tracked, so the next UpdateRoutes ()
+     * recomputes every route.
+     *
+     * @param path the file to read
+     * @returns true if the routes were installed, false if the file is
+     * missing, malformed, of another version or of another topology, in
+     * which case no route is installed
+     */
+    bool LoadRoutingTables(std::string path);
+
+    /**
+     * @brief Schedule an UpdateRoutes () at the end of the hold-down window.
+     *
+     * The window, given by the GBRRouteHoldDown global value, starts with
+     * the first call; the calls made until the update runs are coalesced
+     * into it.
+     */
+    void ScheduleUpdateRoutes();
+
+    /**
+     * @returns the number of route updates run by ScheduleUpdateRoutes ()
+     */
+    uint32_t GetNUpdates() const;
+
+    /**
+     * @returns the number of ScheduleUpdateRoutes () calls coalesced into a
+     * pending update, i.e. the route updates avoided
+     */
+    uint32_t GetNAvoidedUpdates() const;
+
     /**
      * @brief Debugging routine; allow client code to supply a pre-built LSDB
      */
@@ -774,8 +977,380 @@ class RouteManagerImpl
      */
     RouteManagerImpl& operator=(RouteManagerImpl& srmi);
 
+    /**
+     * @brief Construct an SPF worker of a route manager.
+     *
+     * The worker borrows the LSDB and the router snapshot of the manager; it
+     * only owns its SPF state (the root vertex and the LSA status), so
+     * several workers can run SPF calculations concurrently.
+     *
+     * @param manager the route manager the worker computes routes for
+     */
+    explicit RouteManagerImpl(const RouteManagerImpl* manager);
+
+    /**
+     * @brief A route found by an SPF calculation.
+     *
+     * The SPF calculation does not write to the routing protocols directly.
+     * It appends the routes it finds to the route records of its job, and
+     * InitializeRoutes () installs them once every job is done.
+     */
+    struct RouteRecord
+    {
+        /**
+         * @brief The GBR routing table a route is installed in
+         */
+        enum RouteType
+        {
+            HostRoute,      /**< GBR::AddHostRouteTo () */
+            NetworkRoute,   /**< GBR::AddNetworkRouteTo () */
+            ASExternalRoute /**< GBR::AddASExternalRouteTo () */
+        };
+
+        RouteType m_type;         //!< route type
+        Ipv4Address m_routerId;   //!< router whose table receives the route
+        Ipv4Address m_dest;       //!< destination host or network
+        Ipv4Mask m_mask;          //!< destination network mask
+        Ipv4Address m_nextHop;    //!< next hop
+        uint32_t m_interface;     //!< output interface
+        uint32_t m_nextInterface; //!< output interface in next hop (host routes)
+        uint32_t m_distance;      //!< distance to the destination (host routes)
+    };
+
+    typedef std::vector<RouteRecord> RouteRecords_t; //!< container of route records
+
+    /**
+     * @brief One SPF calculation of InitializeRoutes (), i.e., one
+     * (router, neighbor) pair, along with the routes it produces.
+     */
+    struct SPFJob
+    {
+        Ipv4Address m_root;      //!< the neighbor the SPF tree is rooted at
+        Ipv4Address m_initRoot;  //!< the router the routes are computed for
+        LinkRecord* m_link;      //!< link record from the neighbor back to the router
+        uint32_t m_iface;        //!< interface of the router towards the neighbor
+        RouteRecords_t m_routes; //!< routes produced by the job, in install order
+        /// routers whose LSA the calculation read
+        std::vector<Ipv4Address> m_touched;
+    };
+
+    /**
+     * @brief The state of a router needed by the SPF calculation.
+     *
+     * It is captured on the main thread before any SPF calculation starts, so
+     * that the workers never touch the nodes (whose reference counts are not
+     * thread-safe).
+     */
+    struct RouterInfo
+    {
+        Ptr<GBR> m_gbr; //!< routing protocol of the router
+        /// (interface index, local address) of every address of the router
+        std::vector<std::pair<int32_t, Ipv4Address>> m_addresses;
+    };
+
+    /// router ID to router state
+    typedef std::unordered_map<Ipv4Address, RouterInfo, Ipv4AddressHash> RouterInfos_t;
+
+    /**
+     * @brief The node and interface a local IPv4 address is assigned to.
+     */
+    struct InterfaceInfo
+    {
+        uint32_t m_nodeId;    //!< node the address is assigned to
+        uint32_t m_interface; //!< interface index on that node
+    };
+
+    /// local address to interface
+    typedef std::unordered_map<Ipv4Address, InterfaceInfo, Ipv4AddressHash> InterfaceInfos_t;
+
+    /**
+     * @brief Index the routers by router ID and the interfaces of every node
+     * by local address.
+     *
+     * Called by BuildRoutingDatabase (), so that computing and deleting the
+     * routes never has to scan the node list.  When an address or router ID
+     * is assigned twice, the first node in the node list wins.  The
+     * addresses of the routers are also mapped to their router ID, for the
+     * compressed routing tables.
+     */
+    void BuildIndexes(void);
+
+    /**
+     * @brief Hash the routing database, for the snapshots of the routes.
+     *
+     * Covers every LSA of the LSDB and the addresses of the routers, which
+     * are all the SPF calculations read.
+     *
+     * @returns the 64-bit FNV-1a hash of the routing database
+     */
+    uint64_t GetTopologyHash(void) const;
+
+    /**
+     * @brief Select the layout of the routing tables before routes are
+     * installed, from the GBRCompressedTables global value.
+     */
+    void SelectTableLayout(void);
+
+    /// set of router IDs
+    typedef std::unordered_set<Ipv4Address, Ipv4AddressHash> AddressSet_t;
+
+    /**
+     * @brief Initialize the routing protocol of every router of this system.
+     *
+     * Called by InitializeRoutes () and LoadRoutingTables ().  UpdateRoutes ()
+     * only collects the jobs again, unless it falls back to InitializeRoutes ().
+     */
+    void InitializeProtocols();
+
+    /**
+     * @brief Collect the SPF calculations of InitializeRoutes ().
+     *
+     * Also adds the host routes to the other interfaces of each neighbor to
+     * the jobs.
+     *
+     * @param jobs the vector the jobs are appended to
+     */
+    void BuildSPFJobs(std::vector<SPFJob>& jobs);
+
+    /**
+     * @brief Compare the routing database with the one it replaced.
+     *
+     * @param oldLsdb the previous LSDB
+     * @param oldRouters the previous router index
+     * @param changed the set the routers whose LSA or addresses changed are
+     * added to
+     * @returns false if the change cannot be handled incrementally
+     */
+    bool DiffRoutingDatabase(const RouteManagerLSDB* oldLsdb,
+                             const RouterInfos_t& oldRouters,
+                             AddressSet_t& changed) const;
+
+    /**
+     * @brief Delete all the routes of a routing protocol.
+     *
+     * @param gr the routing protocol
+     */
+    void RemoveRoutes(Ptr<GBR> gr);
+
+    /**
+     * @brief Run the update scheduled by ScheduleUpdateRoutes ().
+     */
+    void DoUpdateRoutes();
+
+    /**
+     * @brief Run the SPF calculations of InitializeRoutes ().
+     *
+     * The jobs run on the calling thread, or on a pool of SPF workers if the
+     * GBRSpfThreads global value asks for more than one thread.  Each job
+     * collects its own routes, so the results do not depend on the number of
+     * threads.
+     *
+     * @param jobs the jobs to run
+     */
+    void RunSPFJobs(std::vector<SPFJob>& jobs);
+
+    /**
+     * @brief Get the number of threads to run jobs on.
+     * @param nJobs the number of jobs
+     * @returns the number of threads, at least one
+     */
+    uint32_t GetNThreads(uint32_t nJobs) const;
+
+    /**
+     * @brief Run SPF jobs until none is left.  This is the body of a worker
+     * thread.
+     *
+     * @param jobs the jobs to run
+     * @param next index of the next job to run, shared by the workers
+     */
+    void RunSPFWorker(std::vector<SPFJob>* jobs, std::atomic<uint32_t>* next);
+
+    /**
+     * @brief Run the SPF calculation of a job.
+     *
+     * The calculation runs on the SPF graph if there is one, and on the LSDB
+     * otherwise.
+     *
+     * @param job the job
+     */
+    void RunSPFJob(SPFJob& job);
+
+    struct SPFGraph;
+    struct SPFGraphState;
+
+    /**
+     * @brief Compile the LSDB into a compressed sparse row graph.
+     * @param graph the graph to fill
+     * @returns false if the LSDB has other links than point-to-point and
+     * stub links, zero metrics, or external LSAs
+     */
+    bool BuildSPFGraph(SPFGraph& graph) const;
+
+    /**
+     * @brief Run the SPF calculation of a job on the SPF graph.
+     *
+     * Adds the same routes as SPFCalculate (), host routes first, in the
+     * order the vertices join the tree.
+     *
+     * @param job the job
+     */
+    void GraphSPFCalculate(SPFJob& job);
+
+    struct ReverseSPFState;
+    struct ReverseSPFResult;
+    struct ReverseSPFContext;
+
+    /**
+     * @brief Compute the routes of the SPF jobs with one reverse SPF
+     * calculation per destination router.
+     *
+     * The distances from every router to the destination give the route of
+     * a (router, neighbor) job for every neighbor whose shortest paths do not
+     * all go through the router.  For the others, only the routers the
+     * excluded router dominates in the shortest path graph towards the
+     * destination have to be recomputed.
+     *
+     * Falls back to RunSPFJobs () if there is no SPF graph.
+     *
+     * @param jobs the jobs to run
+     */
+    void RunReverseSPF(std::vector<SPFJob>& jobs);
+
+    /**
+     * @brief Prepare the reverse SPF calculations of the SPF jobs.
+     *
+     * Installs the default route of the jobs whose neighbor is a stub node,
+     * like SPFCalculate (), and indexes the other jobs by router.
+     *
+     * @param jobs the jobs to run
+     * @param context the context to fill
+     */
+    void BuildReverseSPFContext(std::vector<SPFJob>& jobs, ReverseSPFContext& context);
+
+    /**
+     * @brief Order (job, route) pairs by job.
+     * @param a the first pair
+     * @param b the second pair
+     * @returns true if the job of a comes before the job of b
+     */
+    static bool CompareJobRoutes(const std::pair<uint32_t, RouteRecord>& a,
+                                 const std::pair<uint32_t, RouteRecord>& b);
+
+    /**
+     * @brief Run reverse SPF calculations until no destination is left.
+     * This is the body of a worker thread.
+     *
+     * @param context the graph, jobs and results of the calculation
+     * @param next index of the next destination, shared by the workers
+     */
+    static void RunReverseSPFWorker(ReverseSPFContext* context, std::atomic<uint32_t>* next);
+
+    /**
+     * @brief Compute the routes of every job towards one destination router.
+     *
+     * @param context the graph, jobs and results of the calculation
+     * @param dest the index of the destination router
+     * @param state scratch space of the calculation
+     */
+    static void ReverseSPFDestination(ReverseSPFContext* context,
+                                      uint32_t dest,
+                                      ReverseSPFState& state);
+
+    /**
+     * @brief Append a route to the routes of the running job.
+     *
+     * @param type the route type
+     * @param routerId the router whose table receives the route
+     * @param dest the destination host or network
+     * @param mask the destination network mask
+     * @param nextHop the next hop
+     * @param iface the output interface
+     * @param nextIface the output interface in the next hop
+     * @param distance the distance to the destination
+     */
+    void AddRouteRecord(RouteRecord::RouteType type,
+                        Ipv4Address routerId,
+                        Ipv4Address dest,
+                        Ipv4Mask mask,
+                        Ipv4Address nextHop,
+                        uint32_t iface,
+                        uint32_t nextIface = DISTINFINITY,
+                        uint32_t distance = DISTINFINITY);
+
+    /**
+     * @brief Install a route in the routing table of its router.
+     *
+     * With compressed tables, a host route is installed under the router ID
+     * of the router owning its destination, and only if the table has no
+     * route to that router through the same interface and next hop yet: the
+     * routes of a calculation to the addresses of one router only differ by
+     * destination.
+     *
+     * @param route the route
+     */
+    void InstallRoute(const RouteRecord& route);
+
+    /**
+     * @brief The SPF status of an LSA, valid only in the calculation whose
+     * epoch it carries.
+     */
+    struct SPFStamp
+    {
+        uint32_t m_epoch;        //!< calculation that set the status
+        LSA::SPFStatus m_status; //!< status of the LSA
+    };
+
+    /**
+     * @brief Mark every LSA as not explored, for a new calculation.
+     *
+     * Rather than walking the LSDB, this starts a new epoch: the stamps of
+     * the previous calculations no longer match, so it runs in constant
+     * time but when the stamp array grows or the epoch counter wraps.
+     */
+    void ResetSPFStatus(void);
+
+    /**
+     * @brief Get the SPF status of an LSA in the running calculation.
+     * @param lsa the LSA
+     * @returns the status
+     */
+    LSA::SPFStatus GetSPFStatus(LSA* lsa) const;
+
+    /**
+     * @brief Set the SPF status of an LSA in the running calculation.
+     *
+     * The status is kept by the route manager (or the worker) running the
+     * calculation instead of in the shared LSA, at the index of the LSA in
+     * the LSDB.
+     *
+     * @param lsa the LSA
+     * @param status the status
+     */
+    void SetSPFStatus(LSA* lsa, LSA::SPFStatus status);
+
     Vertex* m_spfroot;        //!< the root node
     RouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+    const RouteManagerImpl* m_manager;   //!< the manager owning the LSDB (this, except in workers)
+    RouterInfos_t m_routers;             //!< snapshot of the routers, by router ID
+    InterfaceInfos_t m_interfaces;       //!< interface of every local address
+    HostRouteIndex::Aliases m_routerIds; //!< router ID of every address of a router
+    uint32_t m_nNodes;                   //!< number of nodes when the snapshot was taken
+    std::vector<SPFStamp> m_spfStatus;   //!< LSA status of the calculations, by LSA index
+    uint32_t m_spfEpoch;                 //!< epoch of the running calculation
+    std::vector<LSA*> m_spfTree;         //!< LSAs added to the tree of the running calculation
+    RouteRecords_t* m_routes;            //!< routes of the running job
+    SPFGraph* m_graph;                   //!< compiled LSDB, null if not supported
+    SPFGraphState* m_graphState;         //!< scratch space of GraphSPFCalculate ()
+    ReverseSPFContext* m_lazy;           //!< jobs whose routes ResolveRoutesTo () computes, if lazy
+    VertexArena m_vertexArena;           //!< vertices of the running SPFCalculate ()
+    RouteCandidateQueue m_candidate;     //!< candidate queue of SPFCalculate ()
+    std::vector<SPFJob> m_jobs; //!< jobs of the installed routes, reused by UpdateRoutes ()
+    bool m_jobsTracked;         //!< whether the jobs recorded the LSAs they read
+    bool m_compressedTables;    //!< whether host routes are installed per router
+    uint32_t m_nResolved;       //!< destination routers computed by ResolveRoutesTo ()
+    EventId m_updateEvent;      //!< pending route update
+    uint32_t m_nUpdates;        //!< route updates run after a hold-down window
+    uint32_t m_nAvoidedUpdates; //!< route updates coalesced into a pending one
 
     /**
      * \brief Test if a node is a stub, from an OSPF sense.
@@ -951,6 +1526,19 @@ class RouteManagerImpl
      * \return the outgoing interface number
      */
     int32_t FindOutgoingInterfaceId(Ipv4Address a, Ipv4Mask amask = Ipv4Mask("255.255.255.255"));
+
+    /**
+     * \brief Return the interface number of a router corresponding to a given
+     * IP address and mask
+     *
+     * \param routerId the router
+     * \param a the target IP address
+     * \param amask the target subnet mask
+     * \return the outgoing interface number, or -1 if not found
+     */
+    int32_t FindRouterInterfaceId(Ipv4Address routerId,
+                                  Ipv4Address a,
+                                  Ipv4Mask amask = Ipv4Mask("255.255.255.255")) const;
 };
 
 } // namespace ns3
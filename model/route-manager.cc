@@ -58,6 +58,59 @@ RouteManager::InitializeRoutes(void)
     SimulationSingleton<RouteManagerImpl>::Get()->InitializeRoutes();
 }
 
+void
+RouteManager::UpdateRoutes(void)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    SimulationSingleton<RouteManagerImpl>::Get()->UpdateRoutes();
+}
+
+bool
+RouteManager::ResolveRoutesTo(Ipv4Address dest)
+{
+    NS_LOG_FUNCTION(dest);
+    return SimulationSingleton<RouteManagerImpl>::Get()->ResolveRoutesTo(dest);
+}
+
+uint32_t
+RouteManager::GetNResolved(void)
+{
+    return SimulationSingleton<RouteManagerImpl>::Get()->GetNResolved();
+}
+
+bool
+RouteManager::SaveRoutingTables(std::string path)
+{
+    NS_LOG_FUNCTION(path);
+    return SimulationSingleton<RouteManagerImpl>::Get()->SaveRoutingTables(path);
+}
+
+bool
+RouteManager::LoadRoutingTables(std::string path)
+{
+    NS_LOG_FUNCTION(path);
+    return SimulationSingleton<RouteManagerImpl>::Get()->LoadRoutingTables(path);
+}
+
+void
+RouteManager::ScheduleUpdateRoutes(void)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    SimulationSingleton<RouteManagerImpl>::Get()->ScheduleUpdateRoutes();
+}
+
+uint32_t
+RouteManager::GetNUpdates(void)
+{
+    return SimulationSingleton<RouteManagerImpl>::Get()->GetNUpdates();
+}
+
+uint32_t
+RouteManager::GetNAvoidedUpdates(void)
+{
+    return SimulationSingleton<RouteManagerImpl>::Get()->GetNAvoidedUpdates();
+}
+
 uint32_t
 RouteManager::AllocateRouterId(void)
 {
@@ -22,6 +22,10 @@
 #ifndef ROUTE_MANAGER_H
 #define ROUTE_MANAGER_H
 
+#include "ns3/ipv4-address.h"
+
+#include <string>
+
 namespace ns3
 {
 
@@ -66,6 +70,60 @@ class RouteManager
      */
     static void InitializeRoutes();
 
+    /**
+     * @brief Update the routes after a change of the topology, recomputing
+     * only the SPF calculations the change affects.
+     */
+    static void UpdateRoutes();
+
+    /**
+     * @brief With GBRLazyRoutes, compute and install the routes of every
+     * router to the router owning an address, if not done yet.
+     *
+     * @param dest the destination address
+     * @returns true if routes were installed
+     */
+    static bool ResolveRoutesTo(Ipv4Address dest);
+
+    /**
+     * @returns the number of destination routers whose routes were computed
+     * by ResolveRoutesTo ()
+     */
+    static uint32_t GetNResolved();
+
+    /**
+     * @brief Write the computed routes to a snapshot file.
+     *
+     * @param path the file to write
+     * @returns true if the routes were written
+     */
+    static bool SaveRoutingTables(std::string path);
+
+    /**
+     * @brief After BuildRoutingDatabase (), install the routes of a snapshot
+     * file saved for the same topology, instead of InitializeRoutes ().
+     *
+     * @param path the file to read
+     * @returns true if the routes were installed
+     */
+    static bool LoadRoutingTables(std::string path);
+
+    /**
+     * @brief Schedule an UpdateRoutes () at the end of the GBRRouteHoldDown
+     * window, coalescing the events of the window into a single update.
+     */
+    static void ScheduleUpdateRoutes();
+
+    /**
+     * @returns the number of route updates run by ScheduleUpdateRoutes ()
+     */
+    static uint32_t GetNUpdates();
+
+    /**
+     * @returns the number of route updates avoided by coalescing them
+     */
+    static uint32_t GetNAvoidedUpdates();
+
   private:
     /**
      * @brief Global Route Manager copy construction is disallowed.  There's no
@@ -139,7 +139,8 @@ LSA::LSA()
       m_networkLSANetworkMask("0.0.0.0"),
       m_attachedRouters(),
       m_status(LSA::LSA_SPF_NOT_EXPLORED),
-      m_node_id(0)
+      m_node_id(0),
+      m_index(0xffffffff)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -152,7 +153,8 @@ LSA::LSA(LSA::SPFStatus status, Ipv4Address linkStateId, Ipv4Address advertising
       m_networkLSANetworkMask("0.0.0.0"),
       m_attachedRouters(),
       m_status(status),
-      m_node_id(0)
+      m_node_id(0),
+      m_index(0xffffffff)
 {
     NS_LOG_FUNCTION(this << status << linkStateId << advertisingRtr);
 }
@@ -163,7 +165,8 @@ LSA::LSA(LSA& lsa)
       m_advertisingRtr(lsa.m_advertisingRtr),
       m_networkLSANetworkMask(lsa.m_networkLSANetworkMask),
       m_status(lsa.m_status),
-      m_node_id(lsa.m_node_id)
+      m_node_id(lsa.m_node_id),
+      m_index(0xffffffff)
 {
     NS_LOG_FUNCTION(this << &lsa);
     NS_ASSERT_MSG(IsEmpty(), "LSA::LSA (): Non-empty LSA in constructor");
@@ -374,6 +377,19 @@ LSA::SetStatus(LSA::SPFStatus status)
     m_status = status;
 }
 
+uint32_t
+LSA::GetIndex(void) const
+{
+    return m_index;
+}
+
+void
+LSA::SetIndex(uint32_t index)
+{
+    NS_LOG_FUNCTION(this << index);
+    m_index = index;
+}
+
 Ptr<Node>
 LSA::GetNode(void) const
 {
@@ -489,6 +489,23 @@ class LSA
      */
     void SetStatus(SPFStatus status);
 
+    /**
+     * @brief Get the position of the advertisement in the Link State Database.
+     *
+     * The route manager uses it to keep per-LSA state of its calculations in
+     * arrays instead of in the shared advertisement.
+     *
+     * @see RouteManagerLSDB::Insert ()
+     * @returns The index of the LSA, or 0xffffffff if it is in no database.
+     */
+    uint32_t GetIndex(void) const;
+
+    /**
+     * @brief Set the position of the advertisement in the Link State Database.
+     * @param index the index of the LSA
+     */
+    void SetIndex(uint32_t index);
+
     /**
      * @brief Get the Node pointer of the node that originated this LSA
      * @returns Node pointer
@@ -566,10 +583,12 @@ class LSA
      * This is a tristate flag used internally in the SPF computation to mark
      * if an SPFVertex (a data structure representing a vertex in the SPF tree
      * -- a router) is new, is a candidate for a shortest path, or is in its
-     * proper position in the tree.
+     * proper position in the tree.  The route manager no longer uses it: the
+     * status of its calculations is stamped in arrays indexed by m_index.
      */
     SPFStatus m_status;
     uint32_t m_node_id; //!< node ID
+    uint32_t m_index;   //!< position in the Link State Database
 };
 
 /**
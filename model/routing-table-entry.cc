@@ -29,8 +29,8 @@ RoutingTableEntry::RoutingTableEntry(const RoutingTableEntry& route)
       m_gateway(route.m_gateway),
       m_interface(route.m_interface),
       m_nextInterface(route.m_nextInterface),
-      m_distance(route.m_distance)
-
+      m_distance(route.m_distance),
+      m_route(route.m_route)
 {
     NS_LOG_FUNCTION(this << route);
 }
@@ -41,7 +41,8 @@ RoutingTableEntry::RoutingTableEntry(const RoutingTableEntry* route)
       m_gateway(route->m_gateway),
       m_interface(route->m_interface),
       m_nextInterface(route->m_nextInterface),
-      m_distance(route->m_distance)
+      m_distance(route->m_distance),
+      m_route(route->m_route)
 {
     NS_LOG_FUNCTION(this << route);
 }
@@ -212,6 +213,19 @@ RoutingTableEntry::GetDistance(void) const
     return m_distance;
 }
 
+Ptr<Ipv4Route>
+RoutingTableEntry::GetIpv4Route(void) const
+{
+    return m_route;
+}
+
+void
+RoutingTableEntry::SetIpv4Route(Ptr<Ipv4Route> route)
+{
+    NS_LOG_FUNCTION(this << route);
+    m_route = route;
+}
+
 RoutingTableEntry
 RoutingTableEntry::CreateHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface)
 {
@@ -3,6 +3,8 @@
 #define ROUTING_TABLE_ENTRY_H
 
 #include "ns3/ipv4-address.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ptr.h"
 
 #include <list>
 #include <ostream>
@@ -80,6 +82,20 @@ class RoutingTableEntry
      * \return The Ipv4 interface number used for sending outgoing packets in the next hop
      */
     uint32_t GetNextInterface(void) const;
+    /**
+     * \return The prebuilt Ipv4Route handed out when this entry is selected,
+     * or a null pointer if none has been built yet
+     */
+    Ptr<Ipv4Route> GetIpv4Route(void) const;
+    /**
+     * \brief Set the prebuilt Ipv4Route of this entry.
+     *
+     * The route is shared by every packet forwarded with this entry, so it
+     * must not be modified once set; build a new one instead.
+     *
+     * \param route the Ipv4Route
+     */
+    void SetIpv4Route(Ptr<Ipv4Route> route);
     /**
      * \return An Ipv4RoutingTableEntry object corresponding to the input parameters.
      * \param dest Ipv4Address of the destination
@@ -189,6 +205,7 @@ class RoutingTableEntry
     uint32_t m_interface;       //!< output interface
     uint32_t m_nextInterface;   //!< output interface in next hop
     uint32_t m_distance;        //!< the distance between root and destination
+    Ptr<Ipv4Route> m_route;     //!< prebuilt route handed out on lookups
 };
 
 /**
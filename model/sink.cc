@@ -116,9 +116,18 @@ Time
 Sink::GetDelay(const Ptr<Packet>& p) const
 {
     NS_LOG_FUNCTION(this);
-    TimestampTag txTimeTag;
-    p->PeekPacketTag(txTimeTag);
-    Time txTime = txTimeTag.GetTimestamp();
+    Time txTime;
+    DdrTag ddrTag;
+    if (p->PeekPacketTag(ddrTag))
+    {
+        txTime = ddrTag.GetTxTime();
+    }
+    else
+    {
+        TimestampTag txTimeTag;
+        p->PeekPacketTag(txTimeTag);
+        txTime = txTimeTag.GetTimestamp();
+    }
     Time delay = Simulator::Now() - txTime;
     return delay;
 }
@@ -210,18 +219,29 @@ Sink::HandleRead(Ptr<Socket> socket)
         // packet->PrintPacketTags (std::cout);
         // std::cout << std::endl;
         // get packet
+        DdrTag ddrTag;
         FlagTag flagTag;
-        if (packet->PeekPacketTag(flagTag) && flagTag.GetFlag() == true)
+        BudgetTag bgtTag;
+        bool measure = false;
+        uint32_t budget = 0;
+        if (packet->PeekPacketTag(ddrTag))
+        {
+            measure = ddrTag.GetMeasure();
+            budget = ddrTag.GetBudget();
+        }
+        else if (packet->PeekPacketTag(flagTag) && flagTag.GetFlag() == true)
+        {
+            measure = true;
+            packet->PeekPacketTag(bgtTag);
+            budget = bgtTag.GetBudget();
+        }
+        if (measure)
         {
-            TimestampTag timeTag;
-            packet->PeekPacketTag(timeTag);
             std::ostream* os = m_delayStream->GetStream();
             // timeTag.GetSeconds () << " "
-            BudgetTag bgtTag;
-            packet->PeekPacketTag(bgtTag);
 
-            *os << bgtTag.GetBudget() << std::endl;
-            if (GetDelay(packet).GetMicroSeconds() < bgtTag.GetBudget())
+            *os << budget << std::endl;
+            if (GetDelay(packet).GetMicroSeconds() < budget)
             {
                 *os << "1" << std::endl;
             }
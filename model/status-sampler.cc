@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "status-sampler.h"
+
+#include "ipv4-gbr-routing.h"
+
+#include "ns3/boolean.h"
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("StatusSampler");
+
+/**
+ * \brief Whether the neighbor status of the routers is sampled by the
+ * central sampler instead of one event per router.
+ */
+static GlobalValue g_centralSampler("GBRCentralSampler",
+                                    "Sample the neighbor status of all the GBR routers from a "
+                                    "single event per sample period and phase",
+                                    BooleanValue(false),
+                                    MakeBooleanChecker());
+
+/**
+ * \brief Number of equally spaced phases of a sample period the routers are
+ * spread over by the central sampler.
+ */
+static GlobalValue g_samplerPhaseSlots("GBRSamplerPhaseSlots",
+                                       "Number of phases of a sample period the central sampler "
+                                       "assigns the GBR routers to at random",
+                                       UintegerValue(1),
+                                       MakeUintegerChecker<uint32_t>(1));
+
+StatusSampler::StatusSampler()
+    : m_nEvents(0)
+{
+    NS_LOG_FUNCTION(this);
+    m_rng = CreateObject<UniformRandomVariable>();
+}
+
+StatusSampler::~StatusSampler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+bool
+StatusSampler::IsEnabled(void)
+{
+    BooleanValue enabled;
+    g_centralSampler.GetValue(enabled);
+    return enabled.Get();
+}
+
+void
+StatusSampler::Register(Ptr<GBR> gbr, Time period)
+{
+    NS_LOG_FUNCTION(this << gbr << period);
+    NS_ASSERT_MSG(period.IsStrictlyPositive(), "The sample period must be positive");
+    UintegerValue nSlots;
+    g_samplerPhaseSlots.GetValue(nSlots);
+    uint32_t slot = m_rng->GetInteger(0, nSlots.Get() - 1);
+
+    for (uint32_t i = 0; i < m_phases.size(); i++)
+    {
+        if (m_phases[i].m_period == period && m_phases[i].m_slot == slot)
+        {
+            m_phases[i].m_nodes.push_back(gbr);
+            if (!m_phases[i].m_event.IsRunning())
+            {
+                // an emptied phase resumes on its own instants
+                Time next = GetNextInstant(m_phases[i], Simulator::Now() + TimeStep(1));
+                m_phases[i].m_event =
+                    Simulator::Schedule(next - Simulator::Now(), &StatusSampler::Sample, this, i);
+            }
+            return;
+        }
+    }
+
+    Phase phase;
+    phase.m_period = period;
+    phase.m_slot = slot;
+    phase.m_offset = TimeStep(period.GetTimeStep() * slot / nSlots.Get());
+    phase.m_nodes.push_back(gbr);
+    // the first sample of the router creating a phase is one period after it
+    // starts, as with its own event, delayed to the next instant of the phase
+    Time next = GetNextInstant(phase, Simulator::Now() + period);
+    uint32_t index = m_phases.size();
+    phase.m_event =
+        Simulator::Schedule(next - Simulator::Now(), &StatusSampler::Sample, this, index);
+    m_phases.push_back(phase);
+}
+
+Time
+StatusSampler::GetNextInstant(const Phase& phase, Time t)
+{
+    // the instants of a phase are its offset plus a multiple of its period
+    int64_t period = phase.m_period.GetTimeStep();
+    int64_t since = (t - phase.m_offset).GetTimeStep();
+    int64_t periods = since <= 0 ? 0 : (since + period - 1) / period;
+    return phase.m_offset + TimeStep(periods * period);
+}
+
+void
+StatusSampler::Sample(uint32_t phase)
+{
+    NS_LOG_FUNCTION(this << phase);
+    m_nEvents++;
+    std::vector<Ptr<GBR>>& nodes = m_phases[phase].m_nodes;
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < nodes.size(); i++)
+    {
+        // routers disposed of since the last event are dropped
+        if (nodes[i]->SampleNeighborStatus())
+        {
+            nodes[kept++] = nodes[i];
+        }
+    }
+    nodes.resize(kept);
+    if (!nodes.empty())
+    {
+        m_phases[phase].m_event = Simulator::Schedule(m_phases[phase].m_period,
+                                                      &StatusSampler::Sample,
+                                                      this,
+                                                      phase);
+    }
+}
+
+uint64_t
+StatusSampler::GetNEvents(void) const
+{
+    return m_nEvents;
+}
+
+} // namespace ns3
@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef STATUS_SAMPLER_H
+#define STATUS_SAMPLER_H
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+class GBR;
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Central sampler of the neighbor status of every GBR router.
+ *
+ * Without it, every router schedules its own sampling event each sample
+ * period, so the event queue carries one event per router and period.
+ * When the GBRCentralSampler global value is set, the routers register
+ * with this singleton instead, which samples all the routers sharing a
+ * sample period in a single event per period and phase.
+ *
+ * The phase jitter model is given by the GBRSamplerPhaseSlots global
+ * value: the period is divided into that many equally spaced phases, and
+ * each router is assigned one at random when it registers.  With a single
+ * phase, the default, every router is sampled at the same instant.  The
+ * events of a phase are at its offset within the period plus a multiple of
+ * the period, from the start of the simulation.  The number of events per
+ * period is the number of phases in use, whatever the number of routers;
+ * each router is sampled once per period, in registration order within a
+ * phase, and sends its updates as it would on its own.
+ *
+ * The first sample of a router is at the next event of its phase.  The
+ * router that creates a phase is first sampled one period after it
+ * registers at the earliest, as on its own; a router that joins a phase
+ * already in use is first sampled at the next event of that phase, which
+ * may be less than one period after it registers.
+ */
+class StatusSampler
+{
+  public:
+    StatusSampler();
+    ~StatusSampler();
+
+    /**
+     * \return true if the GBRCentralSampler global value is set
+     */
+    static bool IsEnabled(void);
+
+    /**
+     * \brief Sample a router every period from now on.
+     *
+     * A router registers once; it is dropped at the first event after its
+     * SampleNeighborStatus () returns false.  Its first sample is at the next
+     * event of its phase, less than one period away if the phase is in use.
+     *
+     * \param gbr the routing protocol of the router
+     * \param period the sample period of the router
+     */
+    void Register(Ptr<GBR> gbr, Time period);
+
+    /**
+     * \return the number of sampling events run so far
+     */
+    uint64_t GetNEvents(void) const;
+
+  private:
+    /**
+     * \brief The routers sampled by one event of a period.
+     */
+    struct Phase
+    {
+        Time m_period;                 //!< sample period of the routers
+        uint32_t m_slot;               //!< index of the phase within the period
+        Time m_offset;                 //!< time of the phase within the period
+        std::vector<Ptr<GBR>> m_nodes; //!< routers sampled, in registration order
+        EventId m_event;               //!< next sampling event
+    };
+
+    /**
+     * \brief Get the first instant of a phase at or after a time.
+     * \param phase the phase
+     * \param t the time
+     * \return the first time at or after t that is the offset of the phase
+     * plus a multiple of its period
+     */
+    static Time GetNextInstant(const Phase& phase, Time t);
+
+    /**
+     * \brief Sample the routers of a phase and schedule the next event.
+     * \param phase index of the phase in m_phases
+     */
+    void Sample(uint32_t phase);
+
+    std::vector<Phase> m_phases;      //!< phases of every period in use
+    Ptr<UniformRandomVariable> m_rng; //!< phase assignment of the routers
+    uint64_t m_nEvents;               //!< sampling events run
+};
+
+} // namespace ns3
+
+#endif /* STATUS_SAMPLER_H */
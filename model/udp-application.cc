@@ -12,8 +12,6 @@
 
 #include "packet-tags.h"
 
-#include "ns3/timestamp-tag.h"
-
 #define MAX_UINT_32 0xffffffff
 
 namespace ns3
@@ -127,27 +125,18 @@ UdpApplication::StopApplication(void)
 void
 UdpApplication::SendPacket()
 {
-    TimestampTag txTimeTag;
-    FlagTag flagTag;
-    BudgetTag budgetTag;
+    DdrTag ddrTag;
 
     Ptr<Packet> packet = Create<Packet>(m_packetSize);
-    if (m_priority)
-    {
-        PriorityTag priorityTag;
-        priorityTag.SetPriority(true);
-        packet->AddPacketTag(priorityTag);
-    }
+    ddrTag.SetPriority(m_priority);
     Time txTime = Simulator::Now();
     if (m_budget != MAX_UINT_32)
     {
-        budgetTag.SetBudget(m_budget);
-        packet->AddPacketTag(budgetTag);
+        ddrTag.SetBudget(m_budget);
     }
-    flagTag.SetFlag(m_flag);
-    txTimeTag.SetTimestamp(txTime);
-    packet->AddPacketTag(txTimeTag);
-    packet->AddPacketTag(flagTag);
+    ddrTag.SetMeasure(m_flag);
+    ddrTag.SetTxTime(txTime);
+    packet->AddPacketTag(ddrTag);
     m_socket->Send(packet);
     if (++m_packetSent < m_nPackets)
     {
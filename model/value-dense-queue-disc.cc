@@ -193,8 +193,18 @@ ValueDenseQueueDisc::InitializeParams(void)
 uint32_t
 ValueDenseQueueDisc::EnqueueClassify(Ptr<QueueDiscItem> item)
 {
+    DdrTag ddrTag;
     PriorityTag priorityTag;
-    if (item->GetPacket()->PeekPacketTag(priorityTag))
+    bool priority = false;
+    if (item->GetPacket()->PeekPacketTag(ddrTag))
+    {
+        priority = ddrTag.GetPriority();
+    }
+    else
+    {
+        priority = item->GetPacket()->PeekPacketTag(priorityTag);
+    }
+    if (priority)
     {
         return DELAY_SENSITIVE;
     }